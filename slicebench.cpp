@@ -0,0 +1,71 @@
+// Custom library
+#include "wxVTKSliceView.h"
+
+// VTK
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+// Standard library
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// Times slice extraction of wxVTKSliceView on a synthetic unsigned short
+// stack, 2048 x 2048 x 1000 by default (8 GiB). Every orientation scrolls
+// through the given number of slices; the first extraction of each is not
+// timed. Usage: slicebench [columns] [rows] [slices] [slices to time]
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+  int dims[3] = {2048, 2048, 1000};
+  for (int i = 0; i < 3; i++) {
+    if (argc > i + 1) {
+      dims[i] = std::atoi(argv[i + 1]);
+    }
+  }
+  int steps = argc > 4 ? std::atoi(argv[4]) : 20;
+
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(dims);
+  image->AllocateScalars(VTK_UNSIGNED_SHORT, 1);
+  unsigned short* voxels = static_cast<unsigned short*>(image->GetScalarPointer());
+  const vtkIdType count = static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2];
+  for (vtkIdType i = 0; i < count; i++) {
+    // Cheap noise, so that no slice compresses into a constant
+    voxels[i] = static_cast<unsigned short>((i * 2654435761u) >> 16);
+  }
+
+  vtkSmartPointer<wxVTKSliceCursor> cursor = vtkSmartPointer<wxVTKSliceCursor>::New();
+  vtkSmartPointer<wxVTKSliceView> view = vtkSmartPointer<wxVTKSliceView>::New();
+  view->SetInputData(image);
+  view->SetCursor(cursor);
+  view->SetObliqueNormal(0.3, 0.5, 0.8);
+
+  std::cout << "Image: " << dims[0] << " x " << dims[1] << " x " << dims[2] << " unsigned short\n";
+  std::cout << "orientation\tslice\tms per slice\n";
+
+  const char* names[] = {"sagittal", "coronal", "axial", "oblique"};
+  for (int orientation = wxVTKSliceView::Sagittal; orientation <= wxVTKSliceView::Oblique; orientation++) {
+    cursor->SetPosition(image->GetCenter());
+    view->SetOrientation(orientation);
+    view->Update();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; i++) {
+      view->Scroll(i % 2 ? -1 : 1);
+      view->Update();
+    }
+    double perSlice = 1000.0 * Seconds(start) / steps;
+
+    int extent[6];
+    view->GetOutput()->GetExtent(extent);
+    std::cout << names[orientation] << "\t" << extent[1] - extent[0] + 1 << " x " << extent[3] - extent[2] + 1
+              << "\t" << perSlice << "\n";
+  }
+  return EXIT_SUCCESS;
+}
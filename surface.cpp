@@ -1,6 +1,7 @@
 
 // Custom library
 #include "wxVTKRenderWindowInteractor.h"
+#include "wxVTKMeshVoxelizer.h"
 
 // wxWidgets
 #include <wx/wx.h>
@@ -17,7 +18,6 @@
 #include <vtkRenderer.h>
 #include <vtkSphereSource.h>
 #include <vtkVersion.h>
-#include <vtkVoxelModeller.h>
 #include <vtkMarchingCubes.h>
 
 // Standard library
@@ -47,7 +47,7 @@ public:
   vtkSmartPointer<vtkImageData> volume;
   vtkSmartPointer<vtkImageData> cylinder;
   vtkSmartPointer<vtkSphereSource> sphereSource;
-  vtkSmartPointer<vtkVoxelModeller> voxelModeller;
+  vtkSmartPointer<wxVTKMeshVoxelizer> voxelizer;
   vtkSmartPointer<vtkMarchingCubes> surface;
   vtkSmartPointer<vtkRenderer> renderer;
   vtkSmartPointer<vtkRenderWindow> renderWindow;
@@ -115,8 +115,11 @@ MyFrame::MyFrame(const wxString& title, const wxPoint& pos, const wxSize& size)
   SetStatusText(mystring,1);
   m_pVTKWindow = new wxVTKRenderWindowInteractor(this, MY_VTK_WINDOW);
   m_pVTKWindow->UseCaptureMouseOn(); // TODO: Not sure what this does
-  ConstructVTK();
-  ConfigureVTK();
+  // Show the frame right away and build the pipeline on the first paint
+  m_pVTKWindow->SetDeferredPipeline([this]() {
+    ConstructVTK();
+    ConfigureVTK();
+  });
 }
 
 MyFrame::~MyFrame()
@@ -131,7 +134,7 @@ void MyFrame::ConstructVTK()
   volume = vtkSmartPointer<vtkImageData>::New();
   cylinder = vtkSmartPointer<vtkImageData>::New();
   sphereSource = vtkSmartPointer<vtkSphereSource>::New();
-  voxelModeller = vtkSmartPointer<vtkVoxelModeller>::New();
+  voxelizer = vtkSmartPointer<wxVTKMeshVoxelizer>::New();
   surface = vtkSmartPointer<vtkMarchingCubes>::New();
   renderer = vtkSmartPointer<vtkRenderer>::New();
   mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
@@ -167,12 +170,13 @@ void MyFrame::ConfigureVTK()
     bounds[i + 1] = bounds[i + 1] + 0.1 * range;
   }
 
-  voxelModeller->SetInputConnection(sphereSource->GetOutputPort());
-  voxelModeller->SetSampleDimensions(50, 50, 50);
-  voxelModeller->SetModelBounds(bounds);
-  voxelModeller->SetScalarTypeToFloat();
-  voxelModeller->SetMaximumDistance(0.1);
-  voxelModeller->Update();
+  // Same output as vtkVoxelModeller, but searches a BVH of the triangles in parallel
+  voxelizer->SetInputConnection(sphereSource->GetOutputPort());
+  voxelizer->SetSampleDimensions(50, 50, 50);
+  voxelizer->SetModelBounds(bounds);
+  voxelizer->SetOutputModeToOccupancy();
+  voxelizer->SetMaximumDistance(0.1);
+  voxelizer->Update();
 
   // Alternative image data
   int lim = 200;
@@ -195,7 +199,7 @@ void MyFrame::ConfigureVTK()
   surface->ComputeNormalsOn();
   surface->SetValue(0, isoValue);
 
-  volume->DeepCopy(voxelModeller->GetOutput());
+  volume->DeepCopy(voxelizer->GetOutput());
 
   // The mapper requires our vtkMarchingCubes object
   mapper->SetInputConnection(surface->GetOutputPort());
@@ -1,6 +1,12 @@
 
 // Custom library
 #include "wxVTKRenderWindowInteractor.h"
+#include "wxVTKFrameCapture.h"
+#include "wxVTKMemoryAccountant.h"
+#include "wxVTKResolutionController.h"
+#include "wxVTKSliceView.h"
+#include "wxVTKTrace.h"
+#include "wxVTKVolumeStatistics.h"
 
 // wxWidgets
 #include <wx/wx.h>
@@ -16,7 +22,7 @@
 #include <vtkSmartPointer.h>
 #include <vtkRenderWindow.h>
 #include <vtkRenderer.h>
-#include <vtkSmartVolumeMapper.h>
+#include <vtkFixedPointVolumeRayCastMapper.h>
 #include <vtkColorTransferFunction.h>
 #include <vtkVolumeProperty.h>
 #include <vtkSampleFunction.h>
@@ -26,6 +32,7 @@
 // Standard library
 #include <stdlib.h>
 #include <numeric> // std::iota
+#include <sstream>
 
 class MyApp;
 class MyFrame;
@@ -44,6 +51,11 @@ public:
   ~MyFrame();
   void OnQuit(wxCommandEvent& event);
   void OnAbout(wxCommandEvent& event);
+  void OnSaveStill(wxCommandEvent& event);
+  void OnRecord(wxCommandEvent& event);
+  void OnMemoryUsage(wxCommandEvent& event);
+  void OnTrace(wxCommandEvent& event);
+  void OnMemoryBudgetExceeded();
 
   //Declaring Variables
   vtkSmartPointer<vtkImageData> imageData;
@@ -51,9 +63,13 @@ public:
   vtkSmartPointer<vtkPiecewiseFunction> compositeOpacity;
   vtkSmartPointer<vtkColorTransferFunction> color;
   vtkSmartPointer<vtkVolume> volume;
-  vtkSmartPointer<vtkSmartVolumeMapper> mapper;
+  vtkSmartPointer<vtkFixedPointVolumeRayCastMapper> mapper;
   vtkSmartPointer<vtkRenderer> renderer;
   vtkSmartPointer<vtkRenderWindow> renderWindow;
+  vtkSmartPointer<wxVTKVolumeStatistics> statistics;
+  vtkSmartPointer<wxVTKMemoryAccountant> memory;
+  vtkSmartPointer<wxVTKSliceCursor> sliceCursor;
+  vtkSmartPointer<wxVTKSliceView> sliceViews[3];
 
   //Assigning Values , Allocating Memory
   int X1 = 6;
@@ -69,6 +85,7 @@ protected:
 
 private:
   wxVTKRenderWindowInteractor *m_pVTKWindow;
+  wxVTKRenderWindowInteractor *m_pSliceWindows[3];
 private:
   DECLARE_EVENT_TABLE()
 };
@@ -76,15 +93,26 @@ private:
 enum
 {
   Minimal_Quit = 1,
-  Minimal_About
+  Minimal_About,
+  Minimal_SaveStill,
+  Minimal_Record,
+  Minimal_MemoryUsage,
+  Minimal_Trace
 };
 
 #define MY_FRAME    101
 #define MY_VTK_WINDOW 102
+#define MY_AXIAL_WINDOW 103
+#define MY_CORONAL_WINDOW 104
+#define MY_SAGITTAL_WINDOW 105
 
 BEGIN_EVENT_TABLE(MyFrame, wxFrame)
   EVT_MENU(Minimal_Quit,  MyFrame::OnQuit)
   EVT_MENU(Minimal_About, MyFrame::OnAbout)
+  EVT_MENU(Minimal_SaveStill, MyFrame::OnSaveStill)
+  EVT_MENU(Minimal_Record, MyFrame::OnRecord)
+  EVT_MENU(Minimal_MemoryUsage, MyFrame::OnMemoryUsage)
+  EVT_MENU(Minimal_Trace, MyFrame::OnTrace)
 END_EVENT_TABLE()
 
 IMPLEMENT_APP(MyApp)
@@ -92,7 +120,7 @@ IMPLEMENT_APP(MyApp)
 // 'Main program' equivalent: the program execution "starts" here
 bool MyApp::OnInit()
 {
-  MyFrame *frame = new MyFrame(_T("wxVTK Voxel Cube Demo"), wxPoint(50, 50), wxSize(450, 450));
+  MyFrame *frame = new MyFrame(_T("wxVTK Voxel Cube Demo"), wxPoint(50, 50), wxSize(800, 800));
   frame->Show(TRUE);
   return TRUE;
 }
@@ -103,7 +131,11 @@ MyFrame::MyFrame(const wxString& title, const wxPoint& pos, const wxSize& size)
 
   wxMenu *menuFile = new wxMenu(_T(""), wxMENU_TEAROFF);
   wxMenu *helpMenu = new wxMenu;
+  helpMenu->Append(Minimal_MemoryUsage, _T("&Memory Usage...\tCtrl-M"), _T("Show memory used by the viewer"));
+  helpMenu->AppendCheckItem(Minimal_Trace, _T("&Trace\tCtrl-T"), _T("Trace events and renders to cubedemo_trace.json"));
   helpMenu->Append(Minimal_About, _T("&About...\tCtrl-A"), _T("Show about dialog"));
+  menuFile->Append(Minimal_SaveStill, _T("&Save Still\tCtrl-S"), _T("Save a 4x still as cubedemo.png"));
+  menuFile->AppendCheckItem(Minimal_Record, _T("&Record\tCtrl-R"), _T("Record frames as cubedemo_*.png"));
   menuFile->Append(Minimal_Quit, _T("E&xit\tAlt-X"), _T("Quit this program"));
   wxMenuBar *menuBar = new wxMenuBar();
   menuBar->Append(menuFile, _T("&File"));
@@ -122,12 +154,32 @@ MyFrame::MyFrame(const wxString& title, const wxPoint& pos, const wxSize& size)
   SetStatusText(mystring,1);
   m_pVTKWindow = new wxVTKRenderWindowInteractor(this, MY_VTK_WINDOW);
   m_pVTKWindow->UseCaptureMouseOn(); // TODO: Not sure what this does
-  ConstructVTK();
-  ConfigureVTK();
+  m_pSliceWindows[0] = new wxVTKRenderWindowInteractor(this, MY_AXIAL_WINDOW);
+  m_pSliceWindows[1] = new wxVTKRenderWindowInteractor(this, MY_CORONAL_WINDOW);
+  m_pSliceWindows[2] = new wxVTKRenderWindowInteractor(this, MY_SAGITTAL_WINDOW);
+
+  // Volume top left, axial, coronal and sagittal slices in the other quadrants
+  wxGridSizer *sizer = new wxGridSizer(2, 2, 2, 2);
+  sizer->Add(m_pVTKWindow, 1, wxEXPAND);
+  for (int i = 0; i < 3; i++) {
+    m_pSliceWindows[i]->UseCaptureMouseOn();
+    sizer->Add(m_pSliceWindows[i], 1, wxEXPAND);
+  }
+  SetSizer(sizer);
+  // Show the frame right away and build the pipeline on the first paint
+  m_pVTKWindow->SetDeferredPipeline([this]() {
+    ConstructVTK();
+    ConfigureVTK();
+  });
 }
 
 MyFrame::~MyFrame()
 {
+  // The slice views observe their panes, so they are released first
+  for (int i = 0; i < 3; i++) {
+    sliceViews[i] = NULL;
+    if(m_pSliceWindows[i]) m_pSliceWindows[i]->Delete();
+  }
   if(m_pVTKWindow) m_pVTKWindow->Delete();
   DestroyVTK();
 }
@@ -141,8 +193,14 @@ void MyFrame::ConstructVTK()
   compositeOpacity = vtkSmartPointer<vtkPiecewiseFunction>::New();
   color = vtkSmartPointer<vtkColorTransferFunction>::New();
   volume = vtkSmartPointer<vtkVolume>::New();
-  mapper = vtkSmartPointer<vtkSmartVolumeMapper>::New();
+  mapper = vtkSmartPointer<vtkFixedPointVolumeRayCastMapper>::New();
   renderer = vtkSmartPointer<vtkRenderer>::New();
+  statistics = vtkSmartPointer<wxVTKVolumeStatistics>::New();
+  memory = vtkSmartPointer<wxVTKMemoryAccountant>::New();
+  sliceCursor = vtkSmartPointer<wxVTKSliceCursor>::New();
+  for (int i = 0; i < 3; i++) {
+    sliceViews[i] = vtkSmartPointer<wxVTKSliceView>::New();
+  }
 
 
 }
@@ -154,7 +212,9 @@ void MyFrame::ConfigureVTK()
   
   // Adding a renderer 
   renderWindow->AddRenderer(renderer);
-  renderWindow->SetSize(800, 800);
+
+  // Ray casting is fill-rate bound: trade resolution for frame time while interacting
+  m_pVTKWindow->GetResolutionController()->SetFrameBudget(16.0);
   
   // Adding the cube
   renderer->AddViewProp(volume);
@@ -172,7 +232,6 @@ void MyFrame::ConfigureVTK()
 
   // Setting up mapper
   mapper->SetBlendModeToComposite();
-  mapper->SetRequestedRenderModeToRayCast();
   mapper->SetInputData(imageData);
   
   // Setting up image data
@@ -197,13 +256,38 @@ void MyFrame::ConfigureVTK()
     }
   }
 
-  //Setting Up Display Properties
-  for (int i = 1; i < X1X2X3; i++)
+  // I duplicates the voxel data outside of VTK, so it has to be reported by hand
+  memory->SetRenderWindow(renderWindow);
+  memory->SetExternalAllocation("std::vector<int> I", static_cast<vtkTypeInt64>(I.capacity() * sizeof(int)));
+  // Checked at most once a second after a render, and on Help > Memory Usage
+  memory->SetBudget(vtkTypeInt64(512) * 1024 * 1024);
+  memory->SetCheckInterval(1.0);
+  memory->AddObserver(wxVTKMemoryAccountant::BudgetExceededEvent, this, &MyFrame::OnMemoryBudgetExceeded);
+
+  //Setting Up Display Properties over the scalar range of the data
+  statistics->SetInputData(imageData);
+  statistics->Update();
+  double range[2];
+  statistics->GetRange(range);
+  for (int i = static_cast<int>(range[0]); i < static_cast<int>(range[1]); i++)
   {
     compositeOpacity->AddPoint(i, 1);
     color->AddRGBPoint(i, double(rand()) / RAND_MAX, double(rand()) / RAND_MAX, double(rand()) / RAND_MAX);
   }
 
+  //Slice panes read imageData in place and follow one shared cursor
+  const int orientations[3] = { wxVTKSliceView::Axial, wxVTKSliceView::Coronal, wxVTKSliceView::Sagittal };
+  sliceCursor->SetPosition(imageData->GetCenter());
+  for (int i = 0; i < 3; i++) {
+    sliceViews[i]->SetOrientation(orientations[i]);
+    sliceViews[i]->SetInteractor(m_pSliceWindows[i]);
+    sliceViews[i]->SetInputData(imageData);
+    sliceViews[i]->SetCursor(sliceCursor);
+    sliceViews[i]->SetColorWindow(range[1] - range[0]);
+    sliceViews[i]->SetColorLevel(0.5 * (range[0] + range[1]));
+    m_pSliceWindows[i]->Render();
+  }
+
  }
 
 void MyFrame::DestroyVTK()
@@ -221,3 +305,49 @@ void MyFrame::OnAbout(wxCommandEvent& WXUNUSED(event))
   msg.Printf( _T("This is the about dialog of wx-vtk sample.\n"));
   wxMessageBox(msg, _T("About wx-vtk"), wxOK | wxICON_INFORMATION, this);
 }
+
+void MyFrame::OnSaveStill(wxCommandEvent& WXUNUSED(event))
+{
+  m_pVTKWindow->GetFrameCapture()->CaptureStill("cubedemo.png", 4);
+}
+
+void MyFrame::OnRecord(wxCommandEvent& event)
+{
+  wxVTKFrameCapture* capture = m_pVTKWindow->GetFrameCapture();
+  if (event.IsChecked()) {
+    capture->StartRecording("cubedemo");
+  }
+  else {
+    capture->StopRecording();
+  }
+}
+
+void MyFrame::OnMemoryUsage(wxCommandEvent& WXUNUSED(event))
+{
+  if (!memory) {
+    return;
+  }
+  memory->Update();
+  std::ostringstream report;
+  memory->PrintReport(report);
+  wxMessageBox(wxString(report.str()), _T("Memory Usage"), wxOK | wxICON_INFORMATION, this);
+}
+
+void MyFrame::OnMemoryBudgetExceeded()
+{
+  // Checked after a render, which may run on the render thread
+  CallAfter([this]() { SetStatusText(_T("Memory budget exceeded"), 0); });
+}
+
+void MyFrame::OnTrace(wxCommandEvent& event)
+{
+  if (event.IsChecked()) {
+    wxVTKTrace::Clear();
+    wxVTKTrace::SetEnabled(true);
+  }
+  else {
+    wxVTKTrace::SetEnabled(false);
+    wxVTKTrace::WriteChromeTrace("cubedemo_trace.json");
+    SetStatusText(_T("Trace written to cubedemo_trace.json"), 0);
+  }
+}
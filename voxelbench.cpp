@@ -0,0 +1,91 @@
+
+// Custom library
+#include "wxVTKMeshVoxelizer.h"
+
+// VTK
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkVoxelModeller.h>
+
+// Standard library
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// Compares wxVTKMeshVoxelizer against vtkVoxelModeller on the sphere of the
+// surface demo. Usage: voxelbench [sphere resolution] [largest grid for vtkVoxelModeller]
+
+static double Seconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+  int resolution = argc > 1 ? std::atoi(argv[1]) : 20;
+  int referenceLimit = argc > 2 ? std::atoi(argv[2]) : 512;
+
+  vtkSmartPointer<vtkSphereSource> sphereSource = vtkSmartPointer<vtkSphereSource>::New();
+  sphereSource->SetPhiResolution(resolution);
+  sphereSource->SetThetaResolution(resolution);
+  sphereSource->Update();
+
+  // Same padded bounds as surfdemo
+  double bounds[6];
+  sphereSource->GetOutput()->GetBounds(bounds);
+  for (unsigned int i = 0; i < 6; i += 2)
+  {
+    double range = bounds[i + 1] - bounds[i];
+    bounds[i] = bounds[i] - 0.1 * range;
+    bounds[i + 1] = bounds[i + 1] + 0.1 * range;
+  }
+
+  std::cout << "Triangles: " << sphereSource->GetOutput()->GetNumberOfPolys() << "\n";
+  std::cout << "grid\tvtkVoxelModeller [s]\twxVTKMeshVoxelizer [s]\tmismatching voxels\n";
+
+  const int grids[] = {50, 256, 512};
+  for (int n : grids)
+  {
+    vtkSmartPointer<wxVTKMeshVoxelizer> voxelizer = vtkSmartPointer<wxVTKMeshVoxelizer>::New();
+    voxelizer->SetInputConnection(sphereSource->GetOutputPort());
+    voxelizer->SetSampleDimensions(n, n, n);
+    voxelizer->SetModelBounds(bounds);
+    voxelizer->SetMaximumDistance(0.1);
+    auto start = std::chrono::steady_clock::now();
+    voxelizer->Update();
+    double voxelizerTime = Seconds(start);
+
+    std::cout << n << "^3\t";
+    if (n > referenceLimit)
+    {
+      std::cout << "skipped\t" << voxelizerTime << "\t-\n";
+      continue;
+    }
+
+    vtkSmartPointer<vtkVoxelModeller> voxelModeller = vtkSmartPointer<vtkVoxelModeller>::New();
+    voxelModeller->SetInputConnection(sphereSource->GetOutputPort());
+    voxelModeller->SetSampleDimensions(n, n, n);
+    voxelModeller->SetModelBounds(bounds);
+    voxelModeller->SetScalarTypeToFloat();
+    voxelModeller->SetMaximumDistance(0.1);
+    start = std::chrono::steady_clock::now();
+    voxelModeller->Update();
+    double modellerTime = Seconds(start);
+
+    // Both apply the same closest-point-in-voxel test, so this should print 0;
+    // a closest point exactly on a voxel face may round differently in the two
+    // closest-point routines and flip a voxel
+    vtkDataArray* expected = voxelModeller->GetOutput()->GetPointData()->GetScalars();
+    vtkDataArray* actual = voxelizer->GetOutput()->GetPointData()->GetScalars();
+    vtkIdType mismatches = 0;
+    for (vtkIdType i = 0; i < expected->GetNumberOfTuples(); ++i)
+    {
+      mismatches += (expected->GetTuple1(i) > 0.5) != (actual->GetTuple1(i) > 0.5);
+    }
+    std::cout << modellerTime << "\t" << voxelizerTime << "\t" << mismatches << "\n";
+  }
+  return EXIT_SUCCESS;
+}
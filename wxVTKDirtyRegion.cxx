@@ -0,0 +1,435 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+#include "wxVTKDirtyRegion.h"
+#include <vtkAppendPolyData.h>
+#include <vtkCellArray.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMarchingCubes.h>
+#include <vtkMultiBlockDataSet.h>
+#include <vtkObjectFactory.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Copies the point extent of the source into the brick image, allocating it
+// on first use.
+void CopyBrick(vtkImageData* source, const int extent[6], vtkImageData* brick) {
+  int brickExtent[6];
+  brick->GetExtent(brickExtent);
+  if (!std::equal(brickExtent, brickExtent + 6, extent) || !brick->GetPointData()->GetScalars()) {
+    brick->SetExtent(const_cast<int*>(extent));
+    brick->SetOrigin(source->GetOrigin());
+    brick->SetSpacing(source->GetSpacing());
+    brick->SetDirectionMatrix(source->GetDirectionMatrix());
+    brick->AllocateScalars(source->GetScalarType(), source->GetNumberOfScalarComponents());
+  }
+
+  const size_t rowBytes = static_cast<size_t>(extent[1] - extent[0] + 1)
+    * source->GetScalarSize() * source->GetNumberOfScalarComponents();
+  for (int k = extent[4]; k <= extent[5]; ++k) {
+    for (int j = extent[2]; j <= extent[3]; ++j) {
+      std::memcpy(brick->GetScalarPointer(extent[0], j, k),
+        source->GetScalarPointer(extent[0], j, k), rowBytes);
+    }
+  }
+  brick->GetPointData()->GetScalars()->Modified();
+  brick->Modified();
+}
+
+// Keeps the polygons of a surface contoured on a brick with ghost layers that
+// belong to the brick's own cells, and drops the points they do not use. A
+// polygon lies in the cell that contains its centroid; cells are half-open
+// so a polygon on a shared face goes to one brick only, except on the upper
+// faces of the image.
+void CropToBrick(vtkPolyData* surface, vtkImageData* image, const int extent[6], const int wholeExtent[6], vtkPolyData* output) {
+  vtkPoints* points = surface->GetPoints();
+  vtkDataArray* normals = surface->GetPointData()->GetNormals();
+  vtkNew<vtkPoints> keptPoints;
+  vtkNew<vtkCellArray> keptPolys;
+  vtkSmartPointer<vtkDataArray> keptNormals;
+  if (normals) {
+    keptNormals = vtkSmartPointer<vtkDataArray>::Take(normals->NewInstance());
+    keptNormals->SetNumberOfComponents(3);
+    keptNormals->SetName(normals->GetName());
+  }
+  output->Initialize();
+  if (!points) {
+    return;
+  }
+  keptPoints->SetDataType(points->GetDataType());
+
+  std::vector<vtkIdType> pointMap(surface->GetNumberOfPoints(), -1);
+  vtkCellArray* polys = surface->GetPolys();
+  vtkIdType count;
+  const vtkIdType* ids;
+  for (polys->InitTraversal(); polys->GetNextCell(count, ids);) {
+    double centroid[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType i = 0; i < count; ++i) {
+      double point[3];
+      points->GetPoint(ids[i], point);
+      for (int axis = 0; axis < 3; ++axis) {
+        centroid[axis] += point[axis] / count;
+      }
+    }
+    double index[3];
+    image->TransformPhysicalPointToContinuousIndex(centroid, index);
+    bool inside = true;
+    for (int axis = 0; axis < 3 && inside; ++axis) {
+      const bool closed = extent[2 * axis + 1] == wholeExtent[2 * axis + 1];
+      inside = index[axis] >= extent[2 * axis] &&
+        (closed ? index[axis] <= extent[2 * axis + 1] : index[axis] < extent[2 * axis + 1]);
+    }
+    if (!inside) {
+      continue;
+    }
+    keptPolys->InsertNextCell(count);
+    for (vtkIdType i = 0; i < count; ++i) {
+      vtkIdType& mapped = pointMap[ids[i]];
+      if (mapped < 0) {
+        mapped = keptPoints->InsertNextPoint(points->GetPoint(ids[i]));
+        if (keptNormals) {
+          keptNormals->InsertNextTuple(normals->GetTuple(ids[i]));
+        }
+      }
+      keptPolys->InsertCellPoint(mapped);
+    }
+  }
+  output->SetPoints(keptPoints);
+  output->SetPolys(keptPolys);
+  if (keptNormals) {
+    output->GetPointData()->SetNormals(keptNormals);
+  }
+}
+
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(wxVTKDirtyRegion);
+
+wxVTKDirtyRegion::wxVTKDirtyRegion()
+  : ImageData(NULL)
+  , BrickSize(32)
+  , Extent{0, -1, 0, -1, 0, -1}
+  , Bricks{0, 0, 0}
+{
+}
+
+wxVTKDirtyRegion::~wxVTKDirtyRegion() {
+  SetImageData(NULL);
+}
+
+void wxVTKDirtyRegion::SetImageData(vtkImageData* image) {
+  if (ImageData == image) {
+    return;
+  }
+  if (ImageData) {
+    ImageData->UnRegister(this);
+  }
+  ImageData = image;
+  if (ImageData) {
+    ImageData->Register(this);
+  }
+  UpdateLayout();
+  MarkAllDirty();
+  Modified();
+}
+
+void wxVTKDirtyRegion::SetBrickSize(int size) {
+  size = std::max(size, 1);
+  if (BrickSize == size) {
+    return;
+  }
+  BrickSize = size;
+  UpdateLayout();
+  MarkAllDirty();
+  Modified();
+}
+
+void wxVTKDirtyRegion::UpdateLayout() {
+  if (!ImageData) {
+    Bricks[0] = Bricks[1] = Bricks[2] = 0;
+    BrickTimes.clear();
+    return;
+  }
+  ImageData->GetExtent(Extent);
+  for (int axis = 0; axis < 3; ++axis) {
+    // Bricks share their boundary points, so n bricks cover n * BrickSize + 1 points
+    int cells = Extent[2 * axis + 1] - Extent[2 * axis];
+    Bricks[axis] = std::max(1, (cells + BrickSize - 1) / BrickSize);
+  }
+  BrickTimes.assign(static_cast<size_t>(Bricks[0]) * Bricks[1] * Bricks[2], vtkTimeStamp());
+}
+
+void wxVTKDirtyRegion::MarkDirty(const int extent[6]) {
+  if (!ImageData) {
+    return;
+  }
+  int extentNow[6];
+  ImageData->GetExtent(extentNow);
+  if (!std::equal(extentNow, extentNow + 6, Extent)) {
+    // The image was reallocated behind our back
+    UpdateLayout();
+    MarkAllDirty();
+    return;
+  }
+
+  int lo[3], hi[3];
+  for (int axis = 0; axis < 3; ++axis) {
+    if (extent[2 * axis + 1] < Extent[2 * axis] || extent[2 * axis] > Extent[2 * axis + 1]) {
+      return;
+    }
+    // Grown by one point: central-difference gradients of the neighbouring
+    // points change too, and a brick's seam normals depend on them
+    int a = std::max(extent[2 * axis] - 1, Extent[2 * axis]) - Extent[2 * axis];
+    int b = std::min(extent[2 * axis + 1] + 1, Extent[2 * axis + 1]) - Extent[2 * axis];
+    if (b < a) {
+      return;
+    }
+    // A point on a brick boundary belongs to both neighbouring bricks
+    lo[axis] = a > 0 ? (a - 1) / BrickSize : 0;
+    hi[axis] = std::min(b / BrickSize, Bricks[axis] - 1);
+  }
+
+  for (int k = lo[2]; k <= hi[2]; ++k) {
+    for (int j = lo[1]; j <= hi[1]; ++j) {
+      for (int i = lo[0]; i <= hi[0]; ++i) {
+        BrickTimes[i + Bricks[0] * (j + Bricks[1] * k)].Modified();
+      }
+    }
+  }
+}
+
+void wxVTKDirtyRegion::MarkDirty(int i, int j, int k) {
+  int extent[6] = {i, i, j, j, k, k};
+  MarkDirty(extent);
+}
+
+void wxVTKDirtyRegion::MarkAllDirty() {
+  for (vtkTimeStamp& time : BrickTimes) {
+    time.Modified();
+  }
+}
+
+int wxVTKDirtyRegion::GetNumberOfBricks() {
+  return static_cast<int>(BrickTimes.size());
+}
+
+void wxVTKDirtyRegion::GetBrickDimensions(int dims[3]) {
+  std::copy(Bricks, Bricks + 3, dims);
+}
+
+void wxVTKDirtyRegion::GetBrickExtent(int brickId, int extent[6]) {
+  int index[3] = {
+    brickId % Bricks[0],
+    (brickId / Bricks[0]) % Bricks[1],
+    brickId / (Bricks[0] * Bricks[1])};
+  for (int axis = 0; axis < 3; ++axis) {
+    extent[2 * axis] = Extent[2 * axis] + index[axis] * BrickSize;
+    extent[2 * axis + 1] = std::min(extent[2 * axis] + BrickSize, Extent[2 * axis + 1]);
+  }
+}
+
+vtkMTimeType wxVTKDirtyRegion::GetBrickMTime(int brickId) {
+  return BrickTimes[brickId].GetMTime();
+}
+
+std::vector<int> wxVTKDirtyRegion::GetDirtyBricks(vtkMTimeType since) {
+  std::vector<int> dirty;
+  for (int b = 0; b < GetNumberOfBricks(); ++b) {
+    if (BrickTimes[b].GetMTime() > since) {
+      dirty.push_back(b);
+    }
+  }
+  return dirty;
+}
+
+bool wxVTKDirtyRegion::GetDirtyExtent(vtkMTimeType since, int extent[6]) {
+  bool found = false;
+  for (int b : GetDirtyBricks(since)) {
+    int brick[6];
+    GetBrickExtent(b, brick);
+    for (int axis = 0; axis < 3; ++axis) {
+      extent[2 * axis] = found ? std::min(extent[2 * axis], brick[2 * axis]) : brick[2 * axis];
+      extent[2 * axis + 1] = found ? std::max(extent[2 * axis + 1], brick[2 * axis + 1]) : brick[2 * axis + 1];
+    }
+    found = true;
+  }
+  return found;
+}
+
+void wxVTKDirtyRegion::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "ImageData: " << ImageData << "\n";
+  os << indent << "BrickSize: " << BrickSize << "\n";
+  os << indent << "Bricks: " << Bricks[0] << " x " << Bricks[1] << " x " << Bricks[2] << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(wxVTKBrickedVolume);
+
+wxVTKBrickedVolume::wxVTKBrickedVolume()
+  : DirtyRegion(NULL)
+  , Output(vtkSmartPointer<vtkMultiBlockDataSet>::New())
+{
+}
+
+wxVTKBrickedVolume::~wxVTKBrickedVolume() {
+  SetDirtyRegion(NULL);
+}
+
+vtkCxxSetObjectMacro(wxVTKBrickedVolume, DirtyRegion, wxVTKDirtyRegion);
+
+vtkMultiBlockDataSet* wxVTKBrickedVolume::GetOutput() {
+  return Output;
+}
+
+void wxVTKBrickedVolume::Update() {
+  if (!DirtyRegion || !DirtyRegion->GetImageData()) {
+    return;
+  }
+  vtkImageData* source = DirtyRegion->GetImageData();
+  int count = DirtyRegion->GetNumberOfBricks();
+
+  vtkMTimeType since = UpdateTime.GetMTime();
+  if (static_cast<int>(Output->GetNumberOfBlocks()) != count) {
+    // Layout changed: the mapper has to rebuild its per-block mappers
+    Output->SetNumberOfBlocks(count);
+    Output->Modified();
+    since = 0;
+  }
+
+  for (int b : DirtyRegion->GetDirtyBricks(since)) {
+    int extent[6];
+    DirtyRegion->GetBrickExtent(b, extent);
+    vtkImageData* block = vtkImageData::SafeDownCast(Output->GetBlock(b));
+    if (!block) {
+      vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+      Output->SetBlock(b, image);
+      block = image;
+    }
+    // Only the blocks modified here have their textures uploaded again. The
+    // multiblock itself keeps its MTime so the mapper keeps its per-block mappers.
+    CopyBrick(source, extent, block);
+  }
+  UpdateTime.Modified();
+}
+
+void wxVTKBrickedVolume::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "DirtyRegion: " << DirtyRegion << "\n";
+  os << indent << "Blocks: " << Output->GetNumberOfBlocks() << "\n";
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(wxVTKBrickedIsosurface);
+
+wxVTKBrickedIsosurface::wxVTKBrickedIsosurface()
+  : DirtyRegion(NULL)
+  , Value(0.5)
+  , ComputeNormals(true)
+  , Append(vtkSmartPointer<vtkAppendPolyData>::New())
+{
+}
+
+wxVTKBrickedIsosurface::~wxVTKBrickedIsosurface() {
+  SetDirtyRegion(NULL);
+}
+
+vtkCxxSetObjectMacro(wxVTKBrickedIsosurface, DirtyRegion, wxVTKDirtyRegion);
+
+void wxVTKBrickedIsosurface::SetValue(double value) {
+  if (Value == value) {
+    return;
+  }
+  Value = value;
+  // Every brick has to be contoured again
+  BrickSurfaces.clear();
+  Modified();
+}
+
+void wxVTKBrickedIsosurface::SetComputeNormals(bool computeNormals) {
+  if (ComputeNormals == computeNormals) {
+    return;
+  }
+  ComputeNormals = computeNormals;
+  BrickSurfaces.clear();
+  Modified();
+}
+
+vtkPolyData* wxVTKBrickedIsosurface::GetOutput() {
+  return Append->GetOutput();
+}
+
+void wxVTKBrickedIsosurface::Update() {
+  if (!DirtyRegion || !DirtyRegion->GetImageData()) {
+    return;
+  }
+  vtkImageData* source = DirtyRegion->GetImageData();
+  int count = DirtyRegion->GetNumberOfBricks();
+  int wholeExtent[6];
+  source->GetExtent(wholeExtent);
+
+  vtkMTimeType since = UpdateTime.GetMTime();
+  if (static_cast<int>(BrickSurfaces.size()) != count) {
+    BrickSurfaces.assign(count, NULL);
+    since = 0;
+  }
+
+  std::vector<int> dirty = DirtyRegion->GetDirtyBricks(since);
+  if (dirty.empty() && Append->GetNumberOfInputConnections(0) > 0) {
+    return;
+  }
+
+  vtkSmartPointer<vtkImageData> brick = vtkSmartPointer<vtkImageData>::New();
+  vtkSmartPointer<vtkMarchingCubes> contour = vtkSmartPointer<vtkMarchingCubes>::New();
+  contour->SetValue(0, Value);
+  contour->SetComputeNormals(ComputeNormals);
+  contour->ComputeScalarsOff();
+  for (int b : dirty) {
+    int extent[6];
+    DirtyRegion->GetBrickExtent(b, extent);
+    // One ghost layer per side gives the boundary points central-difference
+    // gradients, so the normals match across the seams
+    int ghostExtent[6];
+    for (int axis = 0; axis < 3; ++axis) {
+      ghostExtent[2 * axis] = std::max(extent[2 * axis] - 1, wholeExtent[2 * axis]);
+      ghostExtent[2 * axis + 1] = std::min(extent[2 * axis + 1] + 1, wholeExtent[2 * axis + 1]);
+    }
+    CopyBrick(source, ghostExtent, brick);
+    contour->SetInputData(brick);
+    contour->Update();
+
+    vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+    CropToBrick(contour->GetOutput(), brick, extent, wholeExtent, surface);
+    BrickSurfaces[b] = surface;
+  }
+
+  Append->RemoveAllInputs();
+  for (const vtkSmartPointer<vtkPolyData>& surface : BrickSurfaces) {
+    if (surface && surface->GetNumberOfPoints() > 0) {
+      Append->AddInputData(surface);
+    }
+  }
+  Append->Update();
+  UpdateTime.Modified();
+}
+
+void wxVTKBrickedIsosurface::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "DirtyRegion: " << DirtyRegion << "\n";
+  os << indent << "Value: " << Value << "\n";
+  os << indent << "ComputeNormals: " << ComputeNormals << "\n";
+}
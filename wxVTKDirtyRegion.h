@@ -0,0 +1,139 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+// Dirty-region tracking for vtkImageData that changes in small regions.
+//
+// The volume is split into bricks of BrickSize^3 voxels. Neighbouring bricks
+// share their boundary layer of points, so each brick can be rendered or
+// contoured on its own without seams. Writers mark the extents they changed;
+// consumers (wxVTKBrickedVolume, wxVTKBrickedIsosurface) compare the per-brick
+// modification times with their own and only redo the bricks that changed.
+
+#pragma once
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimeStamp.h>
+#include <vector>
+
+class vtkImageData;
+class vtkMultiBlockDataSet;
+class vtkPolyData;
+class vtkAppendPolyData;
+
+class wxVTKDirtyRegion : public vtkObject {
+  public:
+  static wxVTKDirtyRegion* New();
+  vtkTypeMacro(wxVTKDirtyRegion, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  // The tracked image. Changing the image or the brick size marks all bricks dirty.
+  void SetImageData(vtkImageData* image);
+  vtkGetObjectMacro(ImageData, vtkImageData);
+  void SetBrickSize(int size);
+  vtkGetMacro(BrickSize, int);
+
+  // Mark the given point extent (imin, imax, jmin, jmax, kmin, kmax) as changed.
+  // Bricks within one point of it are marked too, since their gradients change.
+  void MarkDirty(const int extent[6]);
+  void MarkDirty(int i, int j, int k);
+  void MarkAllDirty();
+
+  int GetNumberOfBricks();
+  void GetBrickDimensions(int dims[3]);
+  void GetBrickExtent(int brickId, int extent[6]);
+  vtkMTimeType GetBrickMTime(int brickId);
+
+  // Bricks changed after the given time, and their bounding point extent.
+  // Returns false if no brick changed.
+  std::vector<int> GetDirtyBricks(vtkMTimeType since);
+  bool GetDirtyExtent(vtkMTimeType since, int extent[6]);
+
+  protected:
+  wxVTKDirtyRegion();
+  ~wxVTKDirtyRegion() override;
+
+  void UpdateLayout();
+
+  vtkImageData* ImageData;
+  int BrickSize;
+  int Extent[6];
+  int Bricks[3];
+  std::vector<vtkTimeStamp> BrickTimes;
+
+  private:
+  wxVTKDirtyRegion(const wxVTKDirtyRegion&) = delete;
+  void operator=(const wxVTKDirtyRegion&) = delete;
+};
+
+// Keeps a vtkMultiBlockDataSet of per-brick images in sync with the source
+// image. Render it with vtkMultiBlockVolumeMapper: every block owns its own
+// texture, so Update() only re-uploads the bricks that were marked dirty.
+class wxVTKBrickedVolume : public vtkObject {
+  public:
+  static wxVTKBrickedVolume* New();
+  vtkTypeMacro(wxVTKBrickedVolume, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  void SetDirtyRegion(wxVTKDirtyRegion* region);
+  vtkGetObjectMacro(DirtyRegion, wxVTKDirtyRegion);
+
+  // Copies dirty bricks from the source image and modifies only those blocks.
+  void Update();
+  vtkMultiBlockDataSet* GetOutput();
+
+  protected:
+  wxVTKBrickedVolume();
+  ~wxVTKBrickedVolume() override;
+
+  wxVTKDirtyRegion* DirtyRegion;
+  vtkSmartPointer<vtkMultiBlockDataSet> Output;
+  vtkTimeStamp UpdateTime;
+
+  private:
+  wxVTKBrickedVolume(const wxVTKBrickedVolume&) = delete;
+  void operator=(const wxVTKBrickedVolume&) = delete;
+};
+
+// Isosurface that re-runs marching cubes only on the dirty bricks and appends
+// the cached surfaces of the unchanged bricks. Each brick is contoured with a
+// ghost layer on every side and cropped back to its own cells, so normals are
+// continuous across the seams. The vertices on a seam are not merged: each
+// brick keeps its own copy, with the same position and normal.
+class wxVTKBrickedIsosurface : public vtkObject {
+  public:
+  static wxVTKBrickedIsosurface* New();
+  vtkTypeMacro(wxVTKBrickedIsosurface, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  void SetDirtyRegion(wxVTKDirtyRegion* region);
+  vtkGetObjectMacro(DirtyRegion, wxVTKDirtyRegion);
+  void SetValue(double value);
+  vtkGetMacro(Value, double);
+  void SetComputeNormals(bool computeNormals);
+  vtkGetMacro(ComputeNormals, bool);
+  vtkBooleanMacro(ComputeNormals, bool);
+
+  void Update();
+  vtkPolyData* GetOutput();
+
+  protected:
+  wxVTKBrickedIsosurface();
+  ~wxVTKBrickedIsosurface() override;
+
+  wxVTKDirtyRegion* DirtyRegion;
+  double Value;
+  bool ComputeNormals;
+  std::vector<vtkSmartPointer<vtkPolyData>> BrickSurfaces;
+  vtkSmartPointer<vtkAppendPolyData> Append;
+  vtkTimeStamp UpdateTime;
+
+  private:
+  wxVTKBrickedIsosurface(const wxVTKBrickedIsosurface&) = delete;
+  void operator=(const wxVTKBrickedIsosurface&) = delete;
+};
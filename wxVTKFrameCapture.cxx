@@ -0,0 +1,355 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+#include "wxVTKFrameCapture.h"
+#include <vtkCommand.h>
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+#include <vtkOpenGLFramebufferObject.h>
+#include <vtkOpenGLRenderWindow.h>
+#include <vtkOpenGLState.h>
+#include <vtkPNGWriter.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkWindowToImageFilter.h>
+#include <vtk_glew.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+vtkStandardNewMacro(wxVTKFrameCapture);
+
+wxVTKFrameCapture::wxVTKFrameCapture()
+  : RenderWindow(NULL)
+  , EndEventTag(0)
+  , NumberOfEncoders(std::max(1u, std::thread::hardware_concurrency() / 2))
+  , NumberOfReadbackBuffers(2)
+  , Recording(false)
+  , CapturingStill(false)
+  , Format(PNG)
+  , FrameIndex(0)
+  , FramesWritten(0)
+  , FramesDropped(0)
+  , NextReadback(0)
+  , Busy(0)
+  , Stopping(false)
+{
+}
+
+wxVTKFrameCapture::~wxVTKFrameCapture() {
+  SetRenderWindow(NULL);
+  StopEncoders();
+}
+
+void wxVTKFrameCapture::SetRenderWindow(vtkRenderWindow* window) {
+  if (RenderWindow == window) {
+    return;
+  }
+  if (RenderWindow) {
+    RenderWindow->RemoveObserver(EndEventTag);
+    RenderWindow->UnRegister(this);
+  }
+  RenderWindow = window;
+  if (RenderWindow) {
+    RenderWindow->Register(this);
+    EndEventTag = RenderWindow->AddObserver(vtkCommand::EndEvent, this, &wxVTKFrameCapture::OnRenderEnd);
+  }
+  Modified();
+}
+
+void wxVTKFrameCapture::StartRecording(const std::string& prefix, int format) {
+  if (Recording) {
+    StopRecording();
+  }
+  StartEncoders();
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    FreeBuffers.clear();
+    for (int i = 0; i < NumberOfReadbackBuffers; ++i) {
+      FreeBuffers.push_back(vtkSmartPointer<vtkUnsignedCharArray>::New());
+    }
+  }
+  Readbacks.assign(NumberOfReadbackBuffers, Readback());
+  NextReadback = 0;
+  Prefix = prefix;
+  Format = format;
+  FrameIndex = 0;
+  FramesWritten = 0;
+  FramesDropped = 0;
+  Recording = true;
+}
+
+void wxVTKFrameCapture::StopRecording() {
+  if (!Recording) {
+    return;
+  }
+  Recording = false;
+  if (RenderWindow) {
+    RunWithContext([this]() {
+      RenderWindow->MakeCurrent();
+      CollectReadbacks(true);
+      ReleaseReadbacks();
+    });
+  }
+  Flush();
+  std::lock_guard<std::mutex> lock(Mutex);
+  FreeBuffers.clear();
+}
+
+void wxVTKFrameCapture::OnRenderEnd() {
+  // The tiles of a still also end in EndEvent and must not be recorded
+  if (!Recording || CapturingStill || !RenderWindow) {
+    return;
+  }
+  vtkOpenGLRenderWindow* glWindow = vtkOpenGLRenderWindow::SafeDownCast(RenderWindow);
+  if (!glWindow) {
+    vtkErrorMacro(<< "Recording requires an OpenGL render window.");
+    Recording = false;
+    return;
+  }
+  int* size = RenderWindow->GetSize();
+  if (size[0] <= 0 || size[1] <= 0) {
+    return;
+  }
+
+  // Frame N-1 has had a whole frame to finish by now
+  CollectReadbacks(false);
+  Readback& readback = Readbacks[NextReadback];
+  if (readback.Pending) {
+    // The GPU is a whole ring behind: drop the frame rather than wait for it
+    ++FramesDropped;
+    return;
+  }
+
+  const size_t bytes = static_cast<size_t>(size[0]) * size[1] * 3;
+  if (!readback.Buffer) {
+    glGenBuffers(1, &readback.Buffer);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.Buffer);
+  if (readback.Size != bytes) {
+    glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+    readback.Size = bytes;
+  }
+  // Same source as GetPixelData(..., front = 1): the resolved display framebuffer
+  vtkOpenGLState* state = glWindow->GetState();
+  state->PushReadFramebufferBinding();
+  glWindow->GetDisplayFramebuffer()->Bind(GL_READ_FRAMEBUFFER);
+  glWindow->GetDisplayFramebuffer()->ActivateReadBuffer(0);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, size[0], size[1], GL_RGB, GL_UNSIGNED_BYTE, NULL);
+  state->PopReadFramebufferBinding();
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  readback.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  readback.Width = size[0];
+  readback.Height = size[1];
+  readback.Pending = true;
+  NextReadback = (NextReadback + 1) % static_cast<int>(Readbacks.size());
+
+  char suffix[64];
+  if (Format == Raw) {
+    std::snprintf(suffix, sizeof(suffix), "_%06lld_%dx%d.raw", static_cast<long long>(FrameIndex), size[0], size[1]);
+  }
+  else {
+    std::snprintf(suffix, sizeof(suffix), "_%06lld.png", static_cast<long long>(FrameIndex));
+  }
+  ++FrameIndex;
+  readback.FileName = Prefix + suffix;
+}
+
+void wxVTKFrameCapture::CollectReadbacks(bool wait) {
+  // Slots are filled round robin, so the oldest pending one follows the next free slot
+  const int count = static_cast<int>(Readbacks.size());
+  for (int n = 0; n < count; ++n) {
+    Readback& readback = Readbacks[(NextReadback + n) % count];
+    if (!readback.Pending) {
+      continue;
+    }
+    GLsync fence = static_cast<GLsync>(readback.Fence);
+    const GLenum status = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GLuint64(1000000000) : 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+      // Later readbacks cannot have finished either
+      return;
+    }
+    glDeleteSync(fence);
+    readback.Fence = NULL;
+    readback.Pending = false;
+
+    vtkSmartPointer<vtkUnsignedCharArray> pixels;
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      if (!FreeBuffers.empty()) {
+        pixels = FreeBuffers.back();
+        FreeBuffers.pop_back();
+      }
+    }
+    if (!pixels) {
+      // The encoders are behind: drop the frame rather than block the render loop
+      ++FramesDropped;
+      continue;
+    }
+    pixels->SetNumberOfComponents(3);
+    pixels->SetNumberOfTuples(static_cast<vtkIdType>(readback.Width) * readback.Height);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.Buffer);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback.Size, GL_MAP_READ_BIT);
+    if (mapped) {
+      std::memcpy(pixels->GetVoidPointer(0), mapped, readback.Size);
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped) {
+      ++FramesDropped;
+      std::lock_guard<std::mutex> lock(Mutex);
+      FreeBuffers.push_back(pixels);
+      continue;
+    }
+    Enqueue({pixels, readback.Width, readback.Height, readback.FileName, Format, true});
+  }
+}
+
+void wxVTKFrameCapture::ReleaseReadbacks() {
+  for (Readback& readback : Readbacks) {
+    if (readback.Fence) {
+      glDeleteSync(static_cast<GLsync>(readback.Fence));
+    }
+    if (readback.Buffer) {
+      glDeleteBuffers(1, &readback.Buffer);
+    }
+  }
+  Readbacks.clear();
+  NextReadback = 0;
+}
+
+void wxVTKFrameCapture::CaptureStill(const std::string& filename, int scale, int format) {
+  if (!RenderWindow) {
+    vtkErrorMacro(<< "CaptureStill() requires a render window.");
+    return;
+  }
+  StartEncoders();
+
+  // The tiles are rendered, so this has to run where the context lives
+  RunWithContext([this, &filename, scale, format]() {
+    vtkSmartPointer<vtkWindowToImageFilter> grabber = vtkSmartPointer<vtkWindowToImageFilter>::New();
+    grabber->SetInput(RenderWindow);
+    grabber->SetScale(std::max(scale, 1));
+    grabber->SetInputBufferTypeToRGB();
+    grabber->ReadFrontBufferOff();
+    grabber->ShouldRerenderOn();
+    CapturingStill = true;
+    grabber->Update();
+    CapturingStill = false;
+
+    vtkImageData* image = grabber->GetOutput();
+    int dims[3];
+    image->GetDimensions(dims);
+    vtkSmartPointer<vtkUnsignedCharArray> pixels = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    pixels->DeepCopy(image->GetPointData()->GetScalars());
+    Enqueue({pixels, dims[0], dims[1], filename, format, false});
+  });
+}
+
+void wxVTKFrameCapture::RunWithContext(const std::function<void()>& task) {
+  if (RunInContext) {
+    RunInContext(task);
+  }
+  else {
+    task();
+  }
+}
+
+void wxVTKFrameCapture::Flush() {
+  std::unique_lock<std::mutex> lock(Mutex);
+  QueueChanged.wait(lock, [this]() { return Queue.empty() && Busy == 0; });
+}
+
+void wxVTKFrameCapture::Enqueue(Job job) {
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    Queue.push_back(std::move(job));
+  }
+  QueueChanged.notify_all();
+}
+
+void wxVTKFrameCapture::StartEncoders() {
+  if (static_cast<int>(Encoders.size()) == NumberOfEncoders) {
+    return;
+  }
+  // Lets the running pool finish the queue before it is resized
+  StopEncoders();
+  Stopping = false;
+  for (int i = 0; i < NumberOfEncoders; ++i) {
+    Encoders.emplace_back(&wxVTKFrameCapture::EncoderLoop, this);
+  }
+}
+
+void wxVTKFrameCapture::StopEncoders() {
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    Stopping = true;
+  }
+  QueueChanged.notify_all();
+  for (std::thread& encoder : Encoders) {
+    encoder.join();
+  }
+  Encoders.clear();
+}
+
+void wxVTKFrameCapture::EncoderLoop() {
+  std::unique_lock<std::mutex> lock(Mutex);
+  for (;;) {
+    QueueChanged.wait(lock, [this]() { return Stopping || !Queue.empty(); });
+    if (Queue.empty()) {
+      // Stopping, and everything queued has been written
+      return;
+    }
+    Job job = std::move(Queue.front());
+    Queue.pop_front();
+    ++Busy;
+    lock.unlock();
+
+    Encode(job);
+    ++FramesWritten;
+
+    lock.lock();
+    --Busy;
+    if (job.Pooled) {
+      FreeBuffers.push_back(job.Pixels);
+    }
+    QueueChanged.notify_all();
+  }
+}
+
+void wxVTKFrameCapture::Encode(const Job& job) {
+  if (job.Format == Raw) {
+    std::ofstream file(job.FileName, std::ios::binary);
+    file.write(static_cast<const char*>(job.Pixels->GetVoidPointer(0)),
+      job.Pixels->GetNumberOfValues());
+    return;
+  }
+
+  // Each job gets its own image and writer so encoders share no VTK state
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(job.Width, job.Height, 1);
+  image->GetPointData()->SetScalars(job.Pixels);
+  vtkSmartPointer<vtkPNGWriter> writer = vtkSmartPointer<vtkPNGWriter>::New();
+  writer->SetFileName(job.FileName.c_str());
+  writer->SetInputData(image);
+  writer->Write();
+}
+
+void wxVTKFrameCapture::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "RenderWindow: " << RenderWindow << "\n";
+  os << indent << "NumberOfEncoders: " << NumberOfEncoders << "\n";
+  os << indent << "NumberOfReadbackBuffers: " << NumberOfReadbackBuffers << "\n";
+  os << indent << "Recording: " << Recording.load() << "\n";
+  os << indent << "FramesWritten: " << FramesWritten.load() << "\n";
+  os << indent << "FramesDropped: " << FramesDropped.load() << "\n";
+}
@@ -0,0 +1,152 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+// Frame capture and video export for wxVTKRenderWindowInteractor.
+//
+// While recording, every rendered frame is read back asynchronously: the
+// glReadPixels of frame N goes into one of a ring of pixel pack buffers (two
+// by default) and is fenced, and the buffer of frame N-1 is mapped while frame
+// N renders. The mapped pixels are copied to a CPU buffer and handed to a pool
+// of encoder threads. If the GPU or the encoders fall behind by a whole ring
+// the frame is dropped instead of stalling the view. Stills larger than the
+// window are rendered in tiles with vtkWindowToImageFilter and encoded on the
+// same pool.
+//
+// GL work requested from outside a render, i.e. stills and the final
+// readbacks of StopRecording(), goes through the context runner, so that it
+// happens on the thread that owns the context.
+
+#pragma once
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class vtkRenderWindow;
+class vtkUnsignedCharArray;
+
+class wxVTKFrameCapture : public vtkObject {
+  public:
+  static wxVTKFrameCapture* New();
+  vtkTypeMacro(wxVTKFrameCapture, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  enum {
+    PNG,
+    // Headerless RGB8 rows, bottom row first; the size is part of the file name
+    Raw
+  };
+
+  void SetRenderWindow(vtkRenderWindow* window);
+  vtkGetObjectMacro(RenderWindow, vtkRenderWindow);
+
+  // Runs a task where the window's context may be made current and returns
+  // once it has finished. Unset, tasks run on the calling thread.
+  using ContextRunner = std::function<void(const std::function<void()>&)>;
+  void SetContextRunner(ContextRunner runner) { RunInContext = std::move(runner); }
+
+  // Take effect on the next StartRecording(); a changed encoder count also
+  // restarts the pool on the next CaptureStill()
+  vtkSetClampMacro(NumberOfEncoders, int, 1, 64);
+  vtkGetMacro(NumberOfEncoders, int);
+  // Pixel pack buffers in flight, and CPU buffers waiting to be encoded
+  vtkSetClampMacro(NumberOfReadbackBuffers, int, 1, 64);
+  vtkGetMacro(NumberOfReadbackBuffers, int);
+
+  // Frames are written to <prefix>_<frame>.png or <prefix>_<frame>_<w>x<h>.raw
+  void StartRecording(const std::string& prefix, int format = PNG);
+  // Collects the readbacks still in flight and waits for the queued frames to
+  // be encoded. Makes the window's context current on the runner's thread.
+  void StopRecording();
+  bool IsRecording() const { return Recording; }
+
+  // Renders the window scale times larger in tiles and encodes it in the
+  // background. Stills are never dropped.
+  void CaptureStill(const std::string& filename, int scale = 1, int format = PNG);
+
+  // Blocks until every queued frame has been written
+  void Flush();
+
+  vtkIdType GetFramesWritten() const { return FramesWritten; }
+  vtkIdType GetFramesDropped() const { return FramesDropped; }
+
+  protected:
+  wxVTKFrameCapture();
+  ~wxVTKFrameCapture() override;
+
+  struct Job {
+    vtkSmartPointer<vtkUnsignedCharArray> Pixels;
+    int Width;
+    int Height;
+    std::string FileName;
+    int Format;
+    bool Pooled;
+  };
+
+  // One asynchronous readback: a pixel pack buffer and the fence that signals
+  // when the glReadPixels into it has finished. The fence is a GLsync, kept
+  // opaque so this header does not need GL.
+  struct Readback {
+    unsigned int Buffer = 0;
+    size_t Size = 0;
+    void* Fence = NULL;
+    int Width = 0;
+    int Height = 0;
+    std::string FileName;
+    bool Pending = false;
+  };
+
+  void OnRenderEnd();
+  // Maps the finished readbacks, oldest first, and queues them for encoding.
+  // With wait set it blocks until all of them have finished.
+  void CollectReadbacks(bool wait);
+  void ReleaseReadbacks();
+  void StartEncoders();
+  void StopEncoders();
+  void EncoderLoop();
+  void Encode(const Job& job);
+  void Enqueue(Job job);
+  void RunWithContext(const std::function<void()>& task);
+
+  vtkRenderWindow* RenderWindow;
+  unsigned long EndEventTag;
+  int NumberOfEncoders;
+  int NumberOfReadbackBuffers;
+  ContextRunner RunInContext;
+
+  // Set by the caller's thread, read in OnRenderEnd() on the render thread
+  std::atomic<bool> Recording;
+  std::atomic<bool> CapturingStill;
+  std::string Prefix;
+  int Format;
+  vtkIdType FrameIndex;
+  std::atomic<vtkIdType> FramesWritten;
+  std::atomic<vtkIdType> FramesDropped;
+
+  std::mutex Mutex;
+  std::condition_variable QueueChanged;
+  std::deque<Job> Queue;
+  std::vector<vtkSmartPointer<vtkUnsignedCharArray>> FreeBuffers;
+  // Pixel pack buffer ring, only touched while the window's context is current
+  std::vector<Readback> Readbacks;
+  int NextReadback;
+  int Busy;
+  bool Stopping;
+  std::vector<std::thread> Encoders;
+
+  private:
+  wxVTKFrameCapture(const wxVTKFrameCapture&) = delete;
+  void operator=(const wxVTKFrameCapture&) = delete;
+};
@@ -0,0 +1,229 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+#include "wxVTKMemoryAccountant.h"
+#include "wxVTKPipeline.h"
+#include <vtkAbstractVolumeMapper.h>
+#include <vtkAlgorithm.h>
+#include <vtkCellArray.h>
+#include <vtkDataArray.h>
+#include <vtkFixedPointVolumeRayCastMapper.h>
+#include <vtkImageData.h>
+#include <vtkMapper.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProp.h>
+#include <vtkRenderWindow.h>
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+
+// Bytes of an array once converted to float for upload
+vtkTypeInt64 FloatBytes(vtkDataArray* array) {
+  return array ? static_cast<vtkTypeInt64>(array->GetNumberOfValues()) * 4 : 0;
+}
+
+// 32-bit indices of the triangles or segments a cell array is drawn with
+vtkTypeInt64 IndexBytes(vtkCellArray* cells, int verticesPerPrimitive) {
+  if (!cells || cells->GetNumberOfCells() == 0) {
+    return 0;
+  }
+  vtkTypeInt64 primitives = cells->GetNumberOfConnectivityIds()
+    - static_cast<vtkTypeInt64>(verticesPerPrimitive - 1) * cells->GetNumberOfCells();
+  return std::max<vtkTypeInt64>(primitives, 0) * verticesPerPrimitive * 4;
+}
+
+double MiB(vtkTypeInt64 bytes) {
+  return bytes / (1024.0 * 1024.0);
+}
+
+}
+
+vtkStandardNewMacro(wxVTKMemoryAccountant);
+
+wxVTKMemoryAccountant::wxVTKMemoryAccountant()
+  : RenderWindow(NULL)
+  , Budget(0)
+  , CheckInterval(1.0)
+  , EndEventTag(0)
+  , TotalCPUBytes(0)
+  , TotalGPUBytes(0)
+{
+}
+
+wxVTKMemoryAccountant::~wxVTKMemoryAccountant() {
+  SetRenderWindow(NULL);
+}
+
+void wxVTKMemoryAccountant::SetRenderWindow(vtkRenderWindow* window) {
+  if (RenderWindow == window) {
+    return;
+  }
+  if (RenderWindow) {
+    RenderWindow->RemoveObserver(EndEventTag);
+    RenderWindow->UnRegister(this);
+  }
+  RenderWindow = window;
+  if (RenderWindow) {
+    RenderWindow->Register(this);
+    EndEventTag = RenderWindow->AddObserver(vtkCommand::EndEvent, this, &wxVTKMemoryAccountant::OnRenderEnd);
+  }
+  Modified();
+}
+
+void wxVTKMemoryAccountant::SetExternalAllocation(const std::string& name, vtkTypeInt64 bytes) {
+  ExternalAllocations[name] = bytes;
+  Modified();
+}
+
+void wxVTKMemoryAccountant::RemoveExternalAllocation(const std::string& name) {
+  if (ExternalAllocations.erase(name)) {
+    Modified();
+  }
+}
+
+void wxVTKMemoryAccountant::Update() {
+  Records.clear();
+  VisitedStages.clear();
+  VisitedData.clear();
+
+  LastCheck = std::chrono::steady_clock::now();
+
+  if (RenderWindow) {
+    wxVTKPipeline::ForEachProp(RenderWindow, [this](vtkProp* prop) { AddProp(prop); });
+
+    // The window's own front and back buffers plus VTK's offscreen render
+    // framebuffer, each with 32-bit colour and depth
+    int* size = RenderWindow->GetSize();
+    wxVTKMemoryRecord framebuffers;
+    framebuffers.Stage = std::string(RenderWindow->GetClassName()) + " framebuffers";
+    framebuffers.GPUBytes = static_cast<vtkTypeInt64>(size[0]) * size[1] * 8
+      * (2 + std::max(1, RenderWindow->GetMultiSamples()));
+    Records.push_back(framebuffers);
+  }
+
+  for (const auto& allocation : ExternalAllocations) {
+    wxVTKMemoryRecord external;
+    external.Stage = allocation.first;
+    external.Prop = "external";
+    external.CPUBytes = allocation.second;
+    Records.push_back(external);
+  }
+
+  TotalCPUBytes = TotalGPUBytes = 0;
+  for (const wxVTKMemoryRecord& record : Records) {
+    TotalCPUBytes += record.CPUBytes;
+    TotalGPUBytes += record.GPUBytes;
+  }
+
+  if (Budget > 0 && GetTotalBytes() > Budget) {
+    this->InvokeEvent(BudgetExceededEvent, this);
+  }
+}
+
+void wxVTKMemoryAccountant::OnRenderEnd() {
+  if (Budget <= 0 || CheckInterval <= 0.0 ||
+    std::chrono::steady_clock::now() - LastCheck < std::chrono::duration<double>(CheckInterval)) {
+    return;
+  }
+  Update();
+}
+
+void wxVTKMemoryAccountant::AddProp(vtkProp* prop) {
+  vtkAlgorithm* mapper = wxVTKPipeline::GetMapper(prop);
+  wxVTKPipeline::ForEachProducer(mapper, [this, mapper, prop](vtkAlgorithm* producer) {
+    AddStage(producer, mapper, prop->GetClassName());
+  });
+}
+
+void wxVTKMemoryAccountant::AddStage(vtkAlgorithm* algorithm, vtkAlgorithm* mapper, const char* prop) {
+  if (std::find(VisitedStages.begin(), VisitedStages.end(), algorithm) != VisitedStages.end()) {
+    return;
+  }
+  VisitedStages.push_back(algorithm);
+
+  vtkDataObject* drawn = mapper ? mapper->GetInputDataObject(0, 0) : NULL;
+  for (int port = 0; port < algorithm->GetNumberOfOutputPorts(); ++port) {
+    vtkDataObject* data = algorithm->GetOutputDataObject(port);
+    if (!data || std::find(VisitedData.begin(), VisitedData.end(), data) != VisitedData.end()) {
+      continue;
+    }
+    VisitedData.push_back(data);
+
+    wxVTKMemoryRecord record;
+    record.Stage = std::string(algorithm->GetClassName()) + ":" + std::to_string(port) + " " + data->GetClassName();
+    record.Prop = prop;
+    record.CPUBytes = static_cast<vtkTypeInt64>(data->GetActualMemorySize()) * 1024;
+    record.GPUBytes = data == drawn ? EstimateGPUBytes(mapper, data) : 0;
+    Records.push_back(record);
+  }
+
+  // Upstream stages are not drawn directly
+  wxVTKPipeline::ForEachProducer(algorithm, [this, prop](vtkAlgorithm* producer) { AddStage(producer, NULL, prop); });
+}
+
+vtkTypeInt64 wxVTKMemoryAccountant::EstimateGPUBytes(vtkAlgorithm* mapper, vtkDataObject* input) {
+  if (vtkFixedPointVolumeRayCastMapper::SafeDownCast(mapper)) {
+    // Ray casts on the CPU and only uploads the finished image
+    return 0;
+  }
+  if (vtkAbstractVolumeMapper::SafeDownCast(mapper)) {
+    // Volume mappers upload the scalars as a 3D texture
+    vtkImageData* image = vtkImageData::SafeDownCast(input);
+    vtkDataArray* scalars = image ? image->GetPointData()->GetScalars() : NULL;
+    return scalars ? static_cast<vtkTypeInt64>(scalars->GetNumberOfValues()) * scalars->GetDataTypeSize() : 0;
+  }
+  if (vtkPolyDataMapper::SafeDownCast(mapper)) {
+    vtkPolyData* polyData = vtkPolyData::SafeDownCast(input);
+    if (!polyData || !polyData->GetPoints()) {
+      return 0;
+    }
+    vtkPointData* pointData = polyData->GetPointData();
+    vtkTypeInt64 bytes = FloatBytes(polyData->GetPoints()->GetData())
+      + FloatBytes(pointData->GetNormals())
+      + FloatBytes(pointData->GetTCoords());
+    if (vtkMapper::SafeDownCast(mapper)->GetScalarVisibility() && pointData->GetScalars()) {
+      // Mapped to RGBA8
+      bytes += static_cast<vtkTypeInt64>(polyData->GetNumberOfPoints()) * 4;
+    }
+    bytes += IndexBytes(polyData->GetPolys(), 3) + IndexBytes(polyData->GetStrips(), 3)
+      + IndexBytes(polyData->GetLines(), 2) + IndexBytes(polyData->GetVerts(), 1);
+    return bytes;
+  }
+  return 0;
+}
+
+void wxVTKMemoryAccountant::PrintReport(ostream& os) {
+  os << std::fixed << std::setprecision(2);
+  for (const wxVTKMemoryRecord& record : Records) {
+    os << std::setw(10) << MiB(record.CPUBytes) << " MiB CPU " << std::setw(10) << MiB(record.GPUBytes)
+       << " MiB GPU  " << record.Stage;
+    if (!record.Prop.empty()) {
+      os << " (" << record.Prop << ")";
+    }
+    os << "\n";
+  }
+  os << std::setw(10) << MiB(TotalCPUBytes) << " MiB CPU " << std::setw(10) << MiB(TotalGPUBytes)
+     << " MiB GPU  total\n";
+  os << std::defaultfloat;
+}
+
+void wxVTKMemoryAccountant::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "RenderWindow: " << RenderWindow << "\n";
+  os << indent << "Budget: " << Budget << "\n";
+  os << indent << "CheckInterval: " << CheckInterval << "\n";
+  os << indent << "TotalCPUBytes: " << TotalCPUBytes << "\n";
+  os << indent << "TotalGPUBytes: " << TotalGPUBytes << "\n";
+  os << indent << "ExternalAllocations: " << ExternalAllocations.size() << "\n";
+}
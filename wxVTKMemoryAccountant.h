@@ -0,0 +1,109 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+// Memory accounting for a render window.
+//
+// Update() walks every prop of every renderer, follows each mapper upstream
+// through the pipeline and records the outputs of every stage once, even if
+// several props share them. CPU sizes come from GetActualMemorySize(). The
+// graphics side is an estimate of what the mappers upload (vertex and index
+// buffers, volume textures) plus the window's framebuffers, since OpenGL does
+// not report allocations portably. Memory the application holds outside of
+// VTK can be registered by name. When the total exceeds the budget,
+// BudgetExceededEvent is invoked with the accountant as call data.
+//
+// While a budget is set, Update() also runs at the end of a render once
+// CheckInterval seconds have passed since the last one. With threaded
+// rendering that check runs on the render thread, so observers of
+// BudgetExceededEvent must hand GUI work to the main thread.
+
+#pragma once
+#include <vtkCommand.h>
+#include <vtkObject.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+class vtkAlgorithm;
+class vtkDataObject;
+class vtkProp;
+class vtkRenderWindow;
+
+struct wxVTKMemoryRecord {
+  // Producing algorithm and output port, e.g. "vtkMarchingCubes:0"
+  std::string Stage;
+  // Class of the prop whose pipeline the stage was first found in
+  std::string Prop;
+  vtkTypeInt64 CPUBytes = 0;
+  vtkTypeInt64 GPUBytes = 0;
+};
+
+class wxVTKMemoryAccountant : public vtkObject {
+  public:
+  static wxVTKMemoryAccountant* New();
+  vtkTypeMacro(wxVTKMemoryAccountant, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  enum {
+    BudgetExceededEvent = vtkCommand::UserEvent + 1000
+  };
+
+  void SetRenderWindow(vtkRenderWindow* window);
+  vtkGetObjectMacro(RenderWindow, vtkRenderWindow);
+
+  // Budget for CPU plus graphics memory in bytes; 0 disables the check
+  vtkSetMacro(Budget, vtkTypeInt64);
+  vtkGetMacro(Budget, vtkTypeInt64);
+
+  // Least seconds between automatic checks after renders; 0 disables them
+  vtkSetMacro(CheckInterval, double);
+  vtkGetMacro(CheckInterval, double);
+
+  // Memory held by the application, e.g. a copy of the voxel data
+  void SetExternalAllocation(const std::string& name, vtkTypeInt64 bytes);
+  void RemoveExternalAllocation(const std::string& name);
+
+  // Walks the scene; invokes BudgetExceededEvent if the total is over budget
+  void Update();
+
+  const std::vector<wxVTKMemoryRecord>& GetRecords() const { return Records; }
+  vtkGetMacro(TotalCPUBytes, vtkTypeInt64);
+  vtkGetMacro(TotalGPUBytes, vtkTypeInt64);
+  vtkTypeInt64 GetTotalBytes() const { return TotalCPUBytes + TotalGPUBytes; }
+
+  // One line per record plus totals, sizes in MiB
+  void PrintReport(ostream& os);
+
+  protected:
+  wxVTKMemoryAccountant();
+  ~wxVTKMemoryAccountant() override;
+
+  void OnRenderEnd();
+  void AddProp(vtkProp* prop);
+  void AddStage(vtkAlgorithm* algorithm, vtkAlgorithm* mapper, const char* prop);
+  static vtkTypeInt64 EstimateGPUBytes(vtkAlgorithm* mapper, vtkDataObject* input);
+
+  vtkRenderWindow* RenderWindow;
+  vtkTypeInt64 Budget;
+  double CheckInterval;
+  unsigned long EndEventTag;
+  std::chrono::steady_clock::time_point LastCheck;
+  std::map<std::string, vtkTypeInt64> ExternalAllocations;
+
+  std::vector<wxVTKMemoryRecord> Records;
+  std::vector<vtkAlgorithm*> VisitedStages;
+  std::vector<vtkDataObject*> VisitedData;
+  vtkTypeInt64 TotalCPUBytes;
+  vtkTypeInt64 TotalGPUBytes;
+
+  private:
+  wxVTKMemoryAccountant(const wxVTKMemoryAccountant&) = delete;
+  void operator=(const wxVTKMemoryAccountant&) = delete;
+};
@@ -0,0 +1,474 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+#include "wxVTKMeshVoxelizer.h"
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkTriangleFilter.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+struct Triangle {
+  double P[3][3];
+
+  double Centroid(int axis) const {
+    return (P[0][axis] + P[1][axis] + P[2][axis]) / 3.0;
+  }
+};
+
+double Dot(const double a[3], const double b[3]) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+void Sub(const double a[3], const double b[3], double out[3]) {
+  out[0] = a[0] - b[0];
+  out[1] = a[1] - b[1];
+  out[2] = a[2] - b[2];
+}
+
+// Squared distance from p to the triangle and the closest point on it
+// (Ericson, Real-Time Collision Detection, 5.1.5)
+double PointTriangleDistance2(const double p[3], const Triangle& t, double closest[3]) {
+  const double* a = t.P[0];
+  const double* b = t.P[1];
+  const double* c = t.P[2];
+  double ab[3], ac[3], ap[3];
+  Sub(b, a, ab);
+  Sub(c, a, ac);
+  Sub(p, a, ap);
+
+  auto distance2 = [&p, closest](const double q[3]) {
+    double d[3];
+    Sub(p, q, d);
+    if (q != closest) {
+      std::copy(q, q + 3, closest);
+    }
+    return Dot(d, d);
+  };
+  auto along = [](const double from[3], const double dir[3], double s, double out[3]) {
+    out[0] = from[0] + s * dir[0];
+    out[1] = from[1] + s * dir[1];
+    out[2] = from[2] + s * dir[2];
+  };
+
+  double d1 = Dot(ab, ap), d2 = Dot(ac, ap);
+  if (d1 <= 0.0 && d2 <= 0.0) {
+    return distance2(a);
+  }
+  double bp[3];
+  Sub(p, b, bp);
+  double d3 = Dot(ab, bp), d4 = Dot(ac, bp);
+  if (d3 >= 0.0 && d4 <= d3) {
+    return distance2(b);
+  }
+  double vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+    along(a, ab, d1 / (d1 - d3), closest);
+    return distance2(closest);
+  }
+  double cp[3];
+  Sub(p, c, cp);
+  double d5 = Dot(ab, cp), d6 = Dot(ac, cp);
+  if (d6 >= 0.0 && d5 <= d6) {
+    return distance2(c);
+  }
+  double vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+    along(a, ac, d2 / (d2 - d6), closest);
+    return distance2(closest);
+  }
+  double va = d3 * d6 - d5 * d4;
+  if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+    double bc[3];
+    Sub(c, b, bc);
+    along(b, bc, (d4 - d3) / ((d4 - d3) + (d5 - d6)), closest);
+    return distance2(closest);
+  }
+  double denom = 1.0 / (va + vb + vc);
+  double v = vb * denom, w = vc * denom;
+  for (int i = 0; i < 3; ++i) {
+    closest[i] = a[i] + ab[i] * v + ac[i] * w;
+  }
+  return distance2(closest);
+}
+
+// Median-split bounding volume hierarchy over the triangles. The left child
+// of an inner node directly follows it; Right holds the index of the other.
+class TriangleBVH {
+  public:
+  explicit TriangleBVH(std::vector<Triangle> triangles) : Triangles(std::move(triangles)) {
+    if (!Triangles.empty()) {
+      Nodes.reserve(2 * Triangles.size() / LeafSize + 1);
+      BuildNode(0, static_cast<int>(Triangles.size()));
+    }
+  }
+
+  // Squared distance to the closest triangle, or limit2 if none is closer
+  double ClosestDistance2(const double p[3], double limit2) const {
+    double best = limit2;
+    int stack[64];
+    int top = 0;
+    if (!Nodes.empty()) {
+      stack[top++] = 0;
+    }
+    while (top > 0) {
+      const Node& node = Nodes[stack[--top]];
+      if (BoxDistance2(node, p) >= best) {
+        continue;
+      }
+      if (node.Count > 0) {
+        for (int t = node.First; t < node.First + node.Count; ++t) {
+          double closest[3];
+          best = std::min(best, PointTriangleDistance2(p, Triangles[t], closest));
+        }
+        continue;
+      }
+      // Visit the nearer child first so the farther one is more likely pruned
+      int left = static_cast<int>(&node - Nodes.data()) + 1;
+      int right = node.Right;
+      if (BoxDistance2(Nodes[left], p) < BoxDistance2(Nodes[right], p)) {
+        std::swap(left, right);
+      }
+      stack[top++] = left;
+      stack[top++] = right;
+    }
+    return best;
+  }
+
+  // Whether accept returns true for any triangle whose bounds overlap the box
+  template <typename Accept>
+  bool AnyInBox(const double lo[3], const double hi[3], Accept&& accept) const {
+    int stack[64];
+    int top = 0;
+    if (!Nodes.empty()) {
+      stack[top++] = 0;
+    }
+    while (top > 0) {
+      int index = stack[--top];
+      const Node& node = Nodes[index];
+      if (hi[0] < node.Lo[0] || lo[0] > node.Hi[0] || hi[1] < node.Lo[1] || lo[1] > node.Hi[1] ||
+        hi[2] < node.Lo[2] || lo[2] > node.Hi[2]) {
+        continue;
+      }
+      if (node.Count > 0) {
+        for (int t = node.First; t < node.First + node.Count; ++t) {
+          if (accept(Triangles[t])) {
+            return true;
+          }
+        }
+        continue;
+      }
+      stack[top++] = index + 1;
+      stack[top++] = node.Right;
+    }
+    return false;
+  }
+
+  // x coordinates where the line (t, y, z) crosses the surface
+  void RowCrossings(double y, double z, std::vector<double>& crossings) const {
+    crossings.clear();
+    int stack[64];
+    int top = 0;
+    if (!Nodes.empty()) {
+      stack[top++] = 0;
+    }
+    while (top > 0) {
+      int index = stack[--top];
+      const Node& node = Nodes[index];
+      if (y < node.Lo[1] || y > node.Hi[1] || z < node.Lo[2] || z > node.Hi[2]) {
+        continue;
+      }
+      if (node.Count > 0) {
+        for (int t = node.First; t < node.First + node.Count; ++t) {
+          double x;
+          if (CrossX(Triangles[t], y, z, x)) {
+            crossings.push_back(x);
+          }
+        }
+        continue;
+      }
+      stack[top++] = index + 1;
+      stack[top++] = node.Right;
+    }
+    std::sort(crossings.begin(), crossings.end());
+  }
+
+  private:
+  static constexpr int LeafSize = 4;
+
+  struct Node {
+    double Lo[3];
+    double Hi[3];
+    int First;
+    int Count;
+    int Right;
+  };
+
+  int BuildNode(int first, int count) {
+    int index = static_cast<int>(Nodes.size());
+    Nodes.push_back(Node());
+    Node node;
+    double centroidLo[3], centroidHi[3];
+    for (int axis = 0; axis < 3; ++axis) {
+      node.Lo[axis] = centroidLo[axis] = VTK_DOUBLE_MAX;
+      node.Hi[axis] = centroidHi[axis] = VTK_DOUBLE_MIN;
+    }
+    for (int t = first; t < first + count; ++t) {
+      for (int axis = 0; axis < 3; ++axis) {
+        for (int v = 0; v < 3; ++v) {
+          node.Lo[axis] = std::min(node.Lo[axis], Triangles[t].P[v][axis]);
+          node.Hi[axis] = std::max(node.Hi[axis], Triangles[t].P[v][axis]);
+        }
+        double centroid = Triangles[t].Centroid(axis);
+        centroidLo[axis] = std::min(centroidLo[axis], centroid);
+        centroidHi[axis] = std::max(centroidHi[axis], centroid);
+      }
+    }
+
+    if (count <= LeafSize) {
+      node.First = first;
+      node.Count = count;
+      node.Right = -1;
+    }
+    else {
+      int axis = 0;
+      for (int a = 1; a < 3; ++a) {
+        if (centroidHi[a] - centroidLo[a] > centroidHi[axis] - centroidLo[axis]) {
+          axis = a;
+        }
+      }
+      int mid = first + count / 2;
+      std::nth_element(Triangles.begin() + first, Triangles.begin() + mid, Triangles.begin() + first + count,
+        [axis](const Triangle& l, const Triangle& r) { return l.Centroid(axis) < r.Centroid(axis); });
+      node.First = first;
+      node.Count = 0;
+      BuildNode(first, mid - first);
+      node.Right = BuildNode(mid, first + count - mid);
+    }
+    Nodes[index] = node;
+    return index;
+  }
+
+  static double BoxDistance2(const Node& node, const double p[3]) {
+    double d2 = 0.0;
+    for (int axis = 0; axis < 3; ++axis) {
+      double d = std::max(std::max(node.Lo[axis] - p[axis], p[axis] - node.Hi[axis]), 0.0);
+      d2 += d * d;
+    }
+    return d2;
+  }
+
+  // Intersection of the x-parallel line through (y, z) with the triangle
+  static bool CrossX(const Triangle& t, double y, double z, double& x) {
+    const double* a = t.P[0];
+    const double* b = t.P[1];
+    const double* c = t.P[2];
+    double w0 = (b[1] - y) * (c[2] - z) - (b[2] - z) * (c[1] - y);
+    double w1 = (c[1] - y) * (a[2] - z) - (c[2] - z) * (a[1] - y);
+    double w2 = (a[1] - y) * (b[2] - z) - (a[2] - z) * (b[1] - y);
+    bool positive = w0 >= 0.0 && w1 >= 0.0 && w2 >= 0.0;
+    bool negative = w0 <= 0.0 && w1 <= 0.0 && w2 <= 0.0;
+    double sum = w0 + w1 + w2;
+    if ((!positive && !negative) || sum == 0.0) {
+      return false;
+    }
+    x = (w0 * a[0] + w1 * b[0] + w2 * c[0]) / sum;
+    return true;
+  }
+
+  std::vector<Triangle> Triangles;
+  std::vector<Node> Nodes;
+};
+
+}
+
+vtkStandardNewMacro(wxVTKMeshVoxelizer);
+
+wxVTKMeshVoxelizer::wxVTKMeshVoxelizer()
+  : OutputMode(Occupancy)
+  , SampleDimensions{50, 50, 50}
+  , ModelBounds{0.0, 0.0, 0.0, 0.0, 0.0, 0.0}
+  , MaximumDistance(1.0)
+{
+  this->SetNumberOfInputPorts(1);
+}
+
+int wxVTKMeshVoxelizer::FillInputPortInformation(int vtkNotUsed(port), vtkInformation* info) {
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkPolyData");
+  return 1;
+}
+
+void wxVTKMeshVoxelizer::ComputeGeometry(vtkDataSet* input, double bounds[6], double spacing[3]) {
+  if (ModelBounds[0] < ModelBounds[1] && ModelBounds[2] < ModelBounds[3] && ModelBounds[4] < ModelBounds[5]) {
+    std::copy(ModelBounds, ModelBounds + 6, bounds);
+  }
+  else if (input && input->GetNumberOfPoints() > 0) {
+    input->GetBounds(bounds);
+  }
+  else {
+    for (int axis = 0; axis < 3; ++axis) {
+      bounds[2 * axis] = 0.0;
+      bounds[2 * axis + 1] = 1.0;
+    }
+  }
+  for (int axis = 0; axis < 3; ++axis) {
+    int samples = std::max(SampleDimensions[axis], 2);
+    spacing[axis] = (bounds[2 * axis + 1] - bounds[2 * axis]) / (samples - 1);
+    if (spacing[axis] <= 0.0) {
+      spacing[axis] = 1.0;
+    }
+  }
+}
+
+int wxVTKMeshVoxelizer::RequestInformation(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector) {
+  vtkInformation* outInfo = outputVector->GetInformationObject(0);
+  vtkDataSet* input = vtkDataSet::GetData(inputVector[0]);
+
+  double bounds[6], spacing[3];
+  ComputeGeometry(input, bounds, spacing);
+  int extent[6] = {0, SampleDimensions[0] - 1, 0, SampleDimensions[1] - 1, 0, SampleDimensions[2] - 1};
+  outInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), extent, 6);
+  outInfo->Set(vtkDataObject::ORIGIN(), bounds[0], bounds[2], bounds[4]);
+  outInfo->Set(vtkDataObject::SPACING(), spacing, 3);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, VTK_FLOAT, 1);
+  return 1;
+}
+
+int wxVTKMeshVoxelizer::RequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector) {
+  vtkPolyData* input = vtkPolyData::GetData(inputVector[0]);
+  vtkImageData* output = vtkImageData::GetData(outputVector);
+
+  // The input bounds are only reliable now, so origin and spacing are set again
+  double bounds[6], spacing[3];
+  ComputeGeometry(input, bounds, spacing);
+  output->SetExtent(0, SampleDimensions[0] - 1, 0, SampleDimensions[1] - 1, 0, SampleDimensions[2] - 1);
+  output->SetOrigin(bounds[0], bounds[2], bounds[4]);
+  output->SetSpacing(spacing);
+  output->AllocateScalars(VTK_FLOAT, 1);
+  output->GetPointData()->GetScalars()->SetName("ImageScalars");
+  float* scalars = static_cast<float*>(output->GetScalarPointer());
+
+  // Gather triangles; polygons and strips are triangulated first
+  std::vector<Triangle> triangles;
+  if (input && input->GetNumberOfCells() > 0) {
+    vtkSmartPointer<vtkTriangleFilter> triangulate = vtkSmartPointer<vtkTriangleFilter>::New();
+    triangulate->SetInputData(input);
+    triangulate->PassVertsOff();
+    triangulate->PassLinesOff();
+    triangulate->Update();
+    vtkPolyData* mesh = triangulate->GetOutput();
+    vtkPoints* points = mesh->GetPoints();
+    triangles.reserve(mesh->GetNumberOfPolys());
+
+    vtkCellArray* polys = mesh->GetPolys();
+    vtkIdType count;
+    const vtkIdType* ids;
+    for (polys->InitTraversal(); polys->GetNextCell(count, ids);) {
+      if (count != 3) {
+        continue;
+      }
+      Triangle t;
+      for (int v = 0; v < 3; ++v) {
+        points->GetPoint(ids[v], t.P[v]);
+      }
+      triangles.push_back(t);
+    }
+  }
+  const TriangleBVH bvh(std::move(triangles));
+
+  double longest = std::max({bounds[1] - bounds[0], bounds[3] - bounds[2], bounds[5] - bounds[4]});
+  const double band = MaximumDistance * longest;
+  const double band2 = band * band;
+  const double half[3] = {spacing[0] / 2.0, spacing[1] / 2.0, spacing[2] / 2.0};
+  const int mode = OutputMode;
+  const int* dims = SampleDimensions;
+  const double origin[3] = {bounds[0], bounds[2], bounds[4]};
+
+  // Rays through exact vertex or edge coordinates would count crossings
+  // twice, so they are nudged off the grid by a tiny irrational offset
+  const double jitter[2] = {spacing[1] * 1.6180339887e-6, spacing[2] * 1.4142135623e-6};
+
+  vtkSMPTools::For(0, static_cast<vtkIdType>(dims[1]) * dims[2], [&](vtkIdType begin, vtkIdType end) {
+    std::vector<double> crossings;
+    for (vtkIdType row = begin; row < end; ++row) {
+      const int j = static_cast<int>(row % dims[1]);
+      const int k = static_cast<int>(row / dims[1]);
+      double p[3] = {origin[0], origin[1] + j * spacing[1], origin[2] + k * spacing[2]};
+      float* out = scalars + row * dims[0];
+
+      size_t crossed = 0;
+      if (mode == SignedDistance) {
+        bvh.RowCrossings(p[1] + jitter[0], p[2] + jitter[1], crossings);
+      }
+
+      for (int i = 0; i < dims[0]; ++i) {
+        p[0] = origin[0] + i * spacing[0];
+        if (mode == Occupancy) {
+          // vtkVoxelModeller's test: a triangle sets the voxel if its closest
+          // point to the voxel centre lies in the voxel, and only within the
+          // index range of the triangle's bounds grown by the band
+          const int index[3] = {i, j, k};
+          const double lo[3] = {p[0] - half[0], p[1] - half[1], p[2] - half[2]};
+          const double hi[3] = {p[0] + half[0], p[1] + half[1], p[2] + half[2]};
+          const bool hit = bvh.AnyInBox(lo, hi, [&](const Triangle& t) {
+            for (int axis = 0; axis < 3; ++axis) {
+              double tLo = std::min({t.P[0][axis], t.P[1][axis], t.P[2][axis]});
+              double tHi = std::max({t.P[0][axis], t.P[1][axis], t.P[2][axis]});
+              if (index[axis] < static_cast<int>((tLo - band - origin[axis]) / spacing[axis]) ||
+                index[axis] > static_cast<int>((tHi + band - origin[axis]) / spacing[axis])) {
+                return false;
+              }
+            }
+            double closest[3];
+            PointTriangleDistance2(p, t, closest);
+            return std::fabs(closest[0] - p[0]) <= half[0] && std::fabs(closest[1] - p[1]) <= half[1] &&
+              std::fabs(closest[2] - p[2]) <= half[2];
+          });
+          out[i] = hit ? 1.0f : 0.0f;
+          continue;
+        }
+        const double d2 = bvh.ClosestDistance2(p, band2);
+        const float distance = static_cast<float>(std::sqrt(d2));
+        if (mode == UnsignedDistance) {
+          out[i] = distance;
+          continue;
+        }
+        while (crossed < crossings.size() && crossings[crossed] < p[0]) {
+          ++crossed;
+        }
+        out[i] = (crossed % 2) ? -distance : distance;
+      }
+    }
+  });
+  return 1;
+}
+
+void wxVTKMeshVoxelizer::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "OutputMode: " << OutputMode << "\n";
+  os << indent << "SampleDimensions: " << SampleDimensions[0] << ", " << SampleDimensions[1] << ", "
+     << SampleDimensions[2] << "\n";
+  os << indent << "ModelBounds: " << ModelBounds[0] << ", " << ModelBounds[1] << ", " << ModelBounds[2] << ", "
+     << ModelBounds[3] << ", " << ModelBounds[4] << ", " << ModelBounds[5] << "\n";
+  os << indent << "MaximumDistance: " << MaximumDistance << "\n";
+}
@@ -0,0 +1,66 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+#include "wxVTKPipeline.h"
+#include <vtkAbstractVolumeMapper.h>
+#include <vtkActor.h>
+#include <vtkAlgorithm.h>
+#include <vtkAlgorithmOutput.h>
+#include <vtkImageMapper3D.h>
+#include <vtkImageSlice.h>
+#include <vtkMapper.h>
+#include <vtkPropCollection.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkRendererCollection.h>
+#include <vtkVolume.h>
+
+vtkAlgorithm* wxVTKPipeline::GetMapper(vtkProp* prop) {
+  if (vtkActor* actor = vtkActor::SafeDownCast(prop)) {
+    return actor->GetMapper();
+  }
+  if (vtkVolume* volume = vtkVolume::SafeDownCast(prop)) {
+    return volume->GetMapper();
+  }
+  if (vtkImageSlice* slice = vtkImageSlice::SafeDownCast(prop)) {
+    return slice->GetMapper();
+  }
+  return NULL;
+}
+
+void wxVTKPipeline::ForEachProp(vtkRenderWindow* window, const std::function<void(vtkProp*)>& visit) {
+  if (!window) {
+    return;
+  }
+  vtkRendererCollection* renderers = window->GetRenderers();
+  vtkCollectionSimpleIterator rit;
+  renderers->InitTraversal(rit);
+  while (vtkRenderer* renderer = renderers->GetNextRenderer(rit)) {
+    vtkPropCollection* props = renderer->GetViewProps();
+    vtkCollectionSimpleIterator pit;
+    props->InitTraversal(pit);
+    while (vtkProp* prop = props->GetNextProp(pit)) {
+      visit(prop);
+    }
+  }
+}
+
+void wxVTKPipeline::ForEachProducer(vtkAlgorithm* algorithm, const std::function<void(vtkAlgorithm*)>& visit) {
+  if (!algorithm) {
+    return;
+  }
+  for (int port = 0; port < algorithm->GetNumberOfInputPorts(); ++port) {
+    for (int c = 0; c < algorithm->GetNumberOfInputConnections(port); ++c) {
+      vtkAlgorithmOutput* input = algorithm->GetInputConnection(port, c);
+      if (input && input->GetProducer()) {
+        visit(input->GetProducer());
+      }
+    }
+  }
+}
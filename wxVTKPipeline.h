@@ -0,0 +1,31 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+// Walks the pipelines behind the props of a render window: from each prop to
+// its mapper and from there upstream through the producers of every input
+// connection. Shared by wxVTKMemoryAccountant and wxVTKTrace.
+
+#pragma once
+#include <functional>
+
+class vtkAlgorithm;
+class vtkProp;
+class vtkRenderWindow;
+
+class wxVTKPipeline {
+  public:
+  // Mapper of an actor, volume or image slice; NULL for other props
+  static vtkAlgorithm* GetMapper(vtkProp* prop);
+
+  // Calls visit with every view prop of every renderer of the window
+  static void ForEachProp(vtkRenderWindow* window, const std::function<void(vtkProp*)>& visit);
+
+  // Calls visit with the producer of every input connection of the algorithm
+  static void ForEachProducer(vtkAlgorithm* algorithm, const std::function<void(vtkAlgorithm*)>& visit);
+};
@@ -0,0 +1,106 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+#include "wxVTKRenderThread.h"
+
+wxVTKRenderThread::wxVTKRenderThread(size_t capacity)
+  : Mask(0)
+  , Head(0)
+  , Tail(0)
+  , Signal(0)
+  , RenderRequested(false)
+  , Continuous(false)
+  , Stopping(false)
+{
+  size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  Tasks.resize(size);
+  Mask = size - 1;
+}
+
+wxVTKRenderThread::~wxVTKRenderThread() {
+  Stop();
+}
+
+void wxVTKRenderThread::Start(std::function<void()> render, std::function<void()> release) {
+  if (IsRunning()) {
+    return;
+  }
+  RenderFrame = std::move(render);
+  ReleaseContext = std::move(release);
+  Stopping.store(false);
+  Thread = std::thread(&wxVTKRenderThread::Loop, this);
+}
+
+void wxVTKRenderThread::Stop() {
+  if (!IsRunning()) {
+    return;
+  }
+  Stopping.store(true, std::memory_order_release);
+  Wake();
+  Thread.join();
+}
+
+void wxVTKRenderThread::Post(std::function<void()> task) {
+  size_t tail = Tail.load(std::memory_order_relaxed);
+  // Full: the render thread is behind by a whole ring; sleep until it frees a slot
+  for (size_t head = Head.load(std::memory_order_acquire); tail - head > Mask; head = Head.load(std::memory_order_acquire)) {
+    Wake();
+    Head.wait(head, std::memory_order_acquire);
+  }
+  Tasks[tail & Mask] = std::move(task);
+  Tail.store(tail + 1, std::memory_order_release);
+  Wake();
+}
+
+void wxVTKRenderThread::RequestRender() {
+  RenderRequested.store(true, std::memory_order_release);
+  Wake();
+}
+
+void wxVTKRenderThread::SetContinuous(bool continuous) {
+  Continuous.store(continuous, std::memory_order_relaxed);
+  Wake();
+}
+
+void wxVTKRenderThread::Wake() {
+  Signal.fetch_add(1, std::memory_order_release);
+  Signal.notify_one();
+}
+
+void wxVTKRenderThread::Loop() {
+  for (;;) {
+    // Read before draining, so a task posted after the drain wakes the wait below
+    unsigned seen = Signal.load(std::memory_order_acquire);
+
+    size_t head = Head.load(std::memory_order_relaxed);
+    while (head != Tail.load(std::memory_order_acquire)) {
+      std::function<void()> task = std::move(Tasks[head & Mask]);
+      Tasks[head & Mask] = nullptr;
+      Head.store(++head, std::memory_order_release);
+      // Cheap unless Post() is waiting for the slot
+      Head.notify_one();
+      task();
+    }
+
+    if (Stopping.load(std::memory_order_acquire)) {
+      break;
+    }
+    if (RenderRequested.exchange(false, std::memory_order_acq_rel) || Continuous.load(std::memory_order_relaxed)) {
+      RenderFrame();
+      continue;
+    }
+    Signal.wait(seen, std::memory_order_acquire);
+  }
+  if (ReleaseContext) {
+    ReleaseContext();
+  }
+}
@@ -0,0 +1,64 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+// Render thread for wxVTKRenderWindowInteractor's threaded mode.
+//
+// The thread owns the OpenGL context while it runs. The GUI thread talks to
+// it through a single-producer single-consumer ring of tasks that needs no
+// locks, and wakes it with an atomic wait/notify. Render requests are
+// coalesced: however many arrive while a frame is drawn, one more frame
+// follows. In continuous mode the thread renders back to back instead.
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+class wxVTKRenderThread {
+  public:
+  // Capacity is rounded up to a power of two
+  explicit wxVTKRenderThread(size_t capacity = 1024);
+  ~wxVTKRenderThread();
+
+  // render draws one frame; release lets go of the context before the thread exits
+  void Start(std::function<void()> render, std::function<void()> release);
+  // Runs the queued tasks, then stops and joins the thread
+  void Stop();
+  bool IsRunning() const { return Thread.joinable(); }
+  bool IsRenderThread() const { return std::this_thread::get_id() == Thread.get_id(); }
+
+  // Producer side; only the GUI thread may post. Blocks while the ring is full.
+  void Post(std::function<void()> task);
+  // Safe from any thread
+  void RequestRender();
+
+  void SetContinuous(bool continuous);
+  bool GetContinuous() const { return Continuous.load(std::memory_order_relaxed); }
+
+  private:
+  wxVTKRenderThread(const wxVTKRenderThread&) = delete;
+  void operator=(const wxVTKRenderThread&) = delete;
+
+  void Wake();
+  void Loop();
+
+  std::vector<std::function<void()>> Tasks;
+  size_t Mask;
+  std::atomic<size_t> Head;
+  std::atomic<size_t> Tail;
+  std::atomic<unsigned> Signal;
+  std::atomic<bool> RenderRequested;
+  std::atomic<bool> Continuous;
+  std::atomic<bool> Stopping;
+
+  std::function<void()> RenderFrame;
+  std::function<void()> ReleaseContext;
+  std::thread Thread;
+};
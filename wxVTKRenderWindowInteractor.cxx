@@ -20,13 +20,23 @@
 =========================================================================*/ 
 
 #include "wxVTKRenderWindowInteractor.h"
+#include "wxVTKFrameCapture.h"
+#include "wxVTKResolutionController.h"
+#include "wxVTKTrace.h"
+#include <wx/thread.h>
 #include <vtkCommand.h>
 #include <vtkDebugLeaks.h>
 #include <vtkInteractorStyleTrackballCamera.h>
 #include <assert.h>
+#include <chrono>
+#include <future>
 
 #define WX_USE_X_CAPTURE 1
 #define ID_wxVTKRenderWindowInteractor_TIMER 1001
+#define ID_wxVTKRenderWindowInteractor_REFINE_TIMER 1002
+
+// Taken during static initialisation, the closest portable stand-in for process start
+static const std::chrono::steady_clock::time_point ProcessStartTime = std::chrono::steady_clock::now();
 
 IMPLEMENT_DYNAMIC_CLASS(wxVTKRenderWindowInteractor, wxWindow)
 BEGIN_EVENT_TABLE(wxVTKRenderWindowInteractor, wxWindow)
@@ -49,16 +59,22 @@ BEGIN_EVENT_TABLE(wxVTKRenderWindowInteractor, wxWindow)
   EVT_KEY_UP(wxVTKRenderWindowInteractor::OnKeyUp)
   EVT_CHAR(wxVTKRenderWindowInteractor::OnChar)
   EVT_TIMER(ID_wxVTKRenderWindowInteractor_TIMER, wxVTKRenderWindowInteractor::OnTimer)
+  EVT_TIMER(ID_wxVTKRenderWindowInteractor_REFINE_TIMER, wxVTKRenderWindowInteractor::OnRefineTimer)
   EVT_SIZE(wxVTKRenderWindowInteractor::OnSize)
+  EVT_IDLE(wxVTKRenderWindowInteractor::OnIdle)
 END_EVENT_TABLE()
 
 wxVTKRenderWindowInteractor::wxVTKRenderWindowInteractor() : wxWindow(), vtkRenderWindowInteractor()
+  , Destroying(false)
+  , FrameCapture(NULL)
+  , ResolutionController(NULL)
+  , RefineDelay(250)
+  , ThreadedRendering(false)
 {
   // TODO: Avoid redundant constructor
-  this->SetInteractorStyle(vtkInteractorStyleTrackballCamera::New());
+  refineTimer.SetOwner(this, ID_wxVTKRenderWindowInteractor_REFINE_TIMER);
   this->RenderWindow = NULL;
-  this->SetRenderWindow(vtkRenderWindow::New());
-  this->RenderWindow->Delete();
+  Timeline.Constructed = GetMillisecondsSinceProcessStart();
 }
 
 wxVTKRenderWindowInteractor::wxVTKRenderWindowInteractor(wxWindow *parent,
@@ -75,18 +91,35 @@ wxVTKRenderWindowInteractor::wxVTKRenderWindowInteractor(wxWindow *parent,
   , Created(true)
   , RenderWhenDisabled(1)
   , UseCaptureMouse(0)
+  , Destroying(false)
+  , FrameCapture(NULL)
+  , ResolutionController(NULL)
+  , refineTimer(this, ID_wxVTKRenderWindowInteractor_REFINE_TIMER)
+  , RefineDelay(250)
+  , ThreadedRendering(false)
 {
 #ifdef VTK_DEBUG_LEAKS
   vtkDebugLeaks::ConstructClass("wxVTKRenderWindowInteractor");
 #endif
-  this->SetInteractorStyle(vtkInteractorStyleTrackballCamera::New());
+  // The render window and interactor style are created by EnsureRenderWindow()
   this->RenderWindow = NULL;
-  this->SetRenderWindow(vtkRenderWindow::New());
-  this->RenderWindow->Delete();
-
+  Timeline.Constructed = GetMillisecondsSinceProcessStart();
 }
 
 wxVTKRenderWindowInteractor::~wxVTKRenderWindowInteractor() {
+  Destroying = true;
+  // Hands the context back before anything it renders is torn down
+  RenderThread.Stop();
+  if (FrameCapture) {
+    // Writes out whatever is still queued
+    FrameCapture->StopRecording();
+    FrameCapture->SetContextRunner(nullptr);
+    FrameCapture->Delete();
+  }
+  refineTimer.Stop();
+  if (ResolutionController) {
+    ResolutionController->Delete();
+  }
   SetRenderWindow(NULL);
   SetInteractorStyle(NULL);
 }
@@ -95,7 +128,158 @@ wxVTKRenderWindowInteractor* wxVTKRenderWindowInteractor::New() {
   return new wxVTKRenderWindowInteractor;
 }
 
+double wxVTKRenderWindowInteractor::GetMillisecondsSinceProcessStart() {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - ProcessStartTime).count();
+}
+
+void wxVTKRenderWindowInteractor::EnsureRenderWindow() {
+  if (Destroying) {
+    return;
+  }
+  // Either may have been set by the caller; only the missing one is created
+  if (!this->InteractorStyle) {
+    vtkInteractorStyleTrackballCamera* style = vtkInteractorStyleTrackballCamera::New();
+    this->SetInteractorStyle(style);
+    style->Delete();
+  }
+  if (RenderWindow) {
+    return;
+  }
+  this->SetRenderWindow(vtkRenderWindow::New());
+  this->RenderWindow->Delete();
+
+  // Size events that arrived before the render window existed were dropped
+  int w, h;
+  GetClientSize(&w, &h);
+  if (w > 0 && h > 0) {
+    UpdateSize(w, h);
+  }
+}
+
+vtkRenderWindow* wxVTKRenderWindowInteractor::GetRenderWindow() {
+  EnsureRenderWindow();
+  return RenderWindow;
+}
+
+wxVTKFrameCapture* wxVTKRenderWindowInteractor::GetFrameCapture() {
+  if (!FrameCapture) {
+    FrameCapture = wxVTKFrameCapture::New();
+    FrameCapture->SetRenderWindow(GetRenderWindow());
+    // Stills and the last readbacks need the context, which the render thread may own
+    FrameCapture->SetContextRunner([this](const std::function<void()>& task) { RunOnRenderThreadAndWait(task); });
+  }
+  return FrameCapture;
+}
+
+wxVTKResolutionController* wxVTKRenderWindowInteractor::GetResolutionController() {
+  if (!ResolutionController) {
+    ResolutionController = wxVTKResolutionController::New();
+    ResolutionController->SetRenderWindow(GetRenderWindow());
+  }
+  return ResolutionController;
+}
+
+void wxVTKRenderWindowInteractor::NotifyInteraction() {
+  if (!ResolutionController) {
+    return;
+  }
+  wxVTKResolutionController* controller = ResolutionController;
+  RunOnRenderThread([controller]() { controller->StartInteraction(); });
+  refineTimer.StartOnce(RefineDelay);
+}
+
+void wxVTKRenderWindowInteractor::OnRefineTimer(wxTimerEvent& WXUNUSED(event)) {
+  if (!ResolutionController) {
+    return;
+  }
+  // The scene has been idle for RefineDelay: render it once at native resolution
+  RunOnRenderThread([this]() {
+    if (ResolutionController->IsInteracting()) {
+      ResolutionController->EndInteraction();
+      Render();
+    }
+  });
+}
+
+void wxVTKRenderWindowInteractor::RunOnRenderThread(std::function<void()> task) {
+  if (RenderThread.IsRunning() && !RenderThread.IsRenderThread()) {
+    RenderThread.Post(std::move(task));
+  }
+  else {
+    task();
+  }
+}
+
+void wxVTKRenderWindowInteractor::RunOnGUIThread(std::function<void()> task) {
+  if (!wxThread::IsMain()) {
+    CallAfter(std::move(task));
+  }
+  else {
+    task();
+  }
+}
+
+void wxVTKRenderWindowInteractor::RunOnRenderThreadAndWait(const std::function<void()>& task) {
+  if (!RenderThread.IsRunning() || RenderThread.IsRenderThread()) {
+    task();
+    return;
+  }
+  // The render thread can only stop through the GUI thread, which waits here
+  std::promise<void> done;
+  std::future<void> finished = done.get_future();
+  RenderThread.Post([&task, &done]() {
+    task();
+    done.set_value();
+  });
+  finished.wait();
+}
+
+void wxVTKRenderWindowInteractor::SetThreadedRendering(bool threaded) {
+  if (ThreadedRendering == threaded) {
+    return;
+  }
+  ThreadedRendering = threaded;
+  if (threaded) {
+    // Without a native window yet the thread starts on the first paint
+    StartRenderThread();
+  }
+  else {
+    RenderThread.Stop();
+    this->Refresh();
+  }
+}
+
+void wxVTKRenderWindowInteractor::SetContinuousRendering(bool continuous) {
+  RenderThread.SetContinuous(continuous);
+}
+
+void wxVTKRenderWindowInteractor::StartRenderThread() {
+  if (!ThreadedRendering || !Handle || RenderThread.IsRunning()) {
+    return;
+  }
+  // A context can only be current on one thread at a time
+  RenderWindow->ReleaseCurrent();
+  RenderThread.Start([this]() { RenderFrame(); }, [this]() { RenderWindow->ReleaseCurrent(); });
+  RenderThread.RequestRender();
+}
+
+void wxVTKRenderWindowInteractor::SetDeferredPipeline(std::function<void()> builder) {
+  DeferredPipeline = std::move(builder);
+}
+
+void wxVTKRenderWindowInteractor::BuildDeferredPipeline() {
+  if (!DeferredPipeline) {
+    return;
+  }
+  // Moved out first so that a builder calling Render() cannot re-enter
+  std::function<void()> builder = std::move(DeferredPipeline);
+  DeferredPipeline = nullptr;
+  builder();
+  Timeline.PipelineReady = GetMillisecondsSinceProcessStart();
+}
+
 void wxVTKRenderWindowInteractor::Initialize() {
+  EnsureRenderWindow();
   int *size = RenderWindow->GetSize();
   Enable();
   Size[0] = size[0];
@@ -137,18 +321,28 @@ void wxVTKRenderWindowInteractor::UpdateSize(int x, int y) {
     if ( x != Size[0] || y != Size[1] ) {
       Size[0] = x;
       Size[1] = y;
-      RenderWindow->SetSize(x, y);
+      RunOnRenderThread([this, x, y]() { RenderWindow->SetSize(x, y); });
       this->Refresh();
     }
   }
 }
 
 int wxVTKRenderWindowInteractor::CreateTimer(int WXUNUSED(timertype)) {
+  if (!wxThread::IsMain()) {
+    CallAfter([this]() { timer.Start(10, TRUE); });
+    return 1;
+  }
   return timer.Start(10,TRUE)? 1 : 0;
 }
 
 int wxVTKRenderWindowInteractor::InternalCreateTimer(int timerId, int timerType, unsigned long duration) {
-  if (!timer.Start(duration, timerType == OneShotTimer))
+  const bool oneShot = timerType == OneShotTimer;
+  if (!wxThread::IsMain()) {
+    // Styles create timers while they handle a posted event; wxTimer is GUI thread only
+    CallAfter([this, duration, oneShot]() { timer.Start(duration, oneShot); });
+    return ID_wxVTKRenderWindowInteractor_TIMER;
+  }
+  if (!timer.Start(duration, oneShot))
     return 0;
 
   return ID_wxVTKRenderWindowInteractor_TIMER;
@@ -156,7 +350,7 @@ int wxVTKRenderWindowInteractor::InternalCreateTimer(int timerId, int timerType,
 
 
 int wxVTKRenderWindowInteractor::InternalDestroyTimer(int platformTimerId) {
-  timer.Stop();
+  RunOnGUIThread([this]() { timer.Stop(); });
   return 1;
 }
 
@@ -166,11 +360,14 @@ int wxVTKRenderWindowInteractor::DestroyTimer() {
 
 
 void wxVTKRenderWindowInteractor::OnTimer(wxTimerEvent& WXUNUSED(event)) {
+  wxVTKTraceScope trace("OnTimer");
   if (!Enabled)
     return;
 
   int timerId = this->GetCurrentTimerId();
-  this->InvokeEvent(vtkCommand::TimerEvent, &timerId);
+  RunOnRenderThread([this, timerId]() mutable {
+    this->InvokeEvent(vtkCommand::TimerEvent, &timerId);
+  });
 
 }
 
@@ -182,22 +379,42 @@ long wxVTKRenderWindowInteractor::GetHandleHack() {
 
 void wxVTKRenderWindowInteractor::OnPaint(wxPaintEvent& WXUNUSED(event)) {
 
+  wxVTKTraceScope trace("OnPaint");
   wxPaintDC pDC(this);
 
+  if (Timeline.FirstPaint < 0) {
+    Timeline.FirstPaint = GetMillisecondsSinceProcessStart();
+  }
+  EnsureRenderWindow();
+
   if(!Handle) {
     Handle = GetHandleHack();
     RenderWindow->SetWindowId(reinterpret_cast<void *>(Handle));
     RenderWindow->SetParentId(reinterpret_cast<void *>(this->GetParent()->GetHandle()));
     this->RenderWindow->SetDisplayId(this->RenderWindow->GetGenericDisplayId());
   }
+  BuildDeferredPipeline();
+  StartRenderThread();
   Render();
 }
 
+void wxVTKRenderWindowInteractor::OnIdle(wxIdleEvent &event) {
+  // Whichever of the first paint or idle event comes first builds the pipeline,
+  // so windows that are not exposed yet still become ready in the background
+  if (DeferredPipeline) {
+    EnsureRenderWindow();
+    BuildDeferredPipeline();
+    this->Refresh();
+  }
+  event.Skip();
+}
+
 void wxVTKRenderWindowInteractor::OnEraseBackground(wxEraseEvent &event) {
   event.Skip(false);
 }
 
 void wxVTKRenderWindowInteractor::OnSize(wxSizeEvent& WXUNUSED(event)) {
+  wxVTKTraceScope trace("OnSize");
   int w, h;
   GetClientSize(&w, &h);
   UpdateSize(w, h);
@@ -206,13 +423,30 @@ void wxVTKRenderWindowInteractor::OnSize(wxSizeEvent& WXUNUSED(event)) {
     return;
   }
 
-  InvokeEvent(vtkCommand::ConfigureEvent, NULL);
+  RunOnRenderThread([this]() { InvokeEvent(vtkCommand::ConfigureEvent, NULL); });
+}
+
+void wxVTKRenderWindowInteractor::DispatchMouseEvent(wxMouseEvent &event, unsigned long vtkEvent) {
+  int x = event.GetX();
+  int y = event.GetY();
+  int ctrl = event.ControlDown();
+  int shift = event.ShiftDown();
+  // Size belongs to the GUI thread, so the flip is done here rather than by
+  // SetEventInformationFlipY() on the render thread
+  int flippedY = Size[1] - y - 1;
+  RunOnRenderThread([this, x, flippedY, ctrl, shift, vtkEvent]() {
+    SetEventInformation(x, flippedY, ctrl, shift, '\0', 0, NULL);
+    InvokeEvent(vtkEvent, NULL);
+  });
 }
 
 void wxVTKRenderWindowInteractor::OnMotion(wxMouseEvent &event) {
+  wxVTKTraceScope trace("OnMotion");
   if (!Enabled) {return;}
-  SetEventInformationFlipY(event.GetX(), event.GetY(), event.ControlDown(), event.ShiftDown(), '\0', 0, NULL);
-  InvokeEvent(vtkCommand::MouseMoveEvent, NULL);
+  if (ActiveButton != wxEVT_NULL) {
+    NotifyInteraction();
+  }
+  DispatchMouseEvent(event, vtkCommand::MouseMoveEvent);
 }
 
 void wxVTKRenderWindowInteractor::OnKeyDown(wxKeyEvent &event) {
@@ -234,7 +468,7 @@ void wxVTKRenderWindowInteractor::OnKeyUp(wxKeyEvent &event)
 
 
 void wxVTKRenderWindowInteractor::OnChar(wxKeyEvent &event) {
-  InvokeEvent(vtkCommand::CharEvent, NULL);
+  RunOnRenderThread([this]() { InvokeEvent(vtkCommand::CharEvent, NULL); });
 }
 
 void wxVTKRenderWindowInteractor::OnButtonDown(wxMouseEvent &event) {
@@ -243,17 +477,16 @@ void wxVTKRenderWindowInteractor::OnButtonDown(wxMouseEvent &event) {
   }
   ActiveButton = event.GetEventType();
   this->SetFocus();
-
-  SetEventInformationFlipY(event.GetX(), event.GetY(), event.ControlDown(), event.ShiftDown(), '\0', 0, NULL);
+  NotifyInteraction();
 
   if(event.RightDown()) {
-    InvokeEvent(vtkCommand::RightButtonPressEvent, NULL);
+    DispatchMouseEvent(event, vtkCommand::RightButtonPressEvent);
   }
   else if(event.LeftDown()) {
-    InvokeEvent(vtkCommand::LeftButtonPressEvent, NULL);
+    DispatchMouseEvent(event, vtkCommand::LeftButtonPressEvent);
   }
   else if(event.MiddleDown()) {
-    InvokeEvent(vtkCommand::MiddleButtonPressEvent, NULL);
+    DispatchMouseEvent(event, vtkCommand::MiddleButtonPressEvent);
   }
   if ((ActiveButton != wxEVT_NULL) && WX_USE_X_CAPTURE && UseCaptureMouse) {
     CaptureMouse();
@@ -267,20 +500,19 @@ void wxVTKRenderWindowInteractor::OnButtonUp(wxMouseEvent &event) {
   }
 
   this->SetFocus();
-  SetEventInformationFlipY(event.GetX(), event.GetY(), event.ControlDown(), event.ShiftDown(), '\0', 0, NULL);
   
   if(ActiveButton == wxEVT_RIGHT_DOWN)
   {
-    InvokeEvent(vtkCommand::RightButtonReleaseEvent, NULL);
+    DispatchMouseEvent(event, vtkCommand::RightButtonReleaseEvent);
   }
   else if(ActiveButton == wxEVT_LEFT_DOWN)
   {
 
-    InvokeEvent(vtkCommand::LeftButtonReleaseEvent, NULL);
+    DispatchMouseEvent(event, vtkCommand::LeftButtonReleaseEvent);
   }
   else if(ActiveButton == wxEVT_MIDDLE_DOWN)
   {
-    InvokeEvent(vtkCommand::MiddleButtonReleaseEvent, NULL);
+    DispatchMouseEvent(event, vtkCommand::MiddleButtonReleaseEvent);
   }
 
   if ((ActiveButton != wxEVT_NULL) && WX_USE_X_CAPTURE && UseCaptureMouse)
@@ -293,20 +525,38 @@ void wxVTKRenderWindowInteractor::OnButtonUp(wxMouseEvent &event) {
 
 void wxVTKRenderWindowInteractor::OnMouseWheel(wxMouseEvent& event) {
 
-    SetEventInformationFlipY(event.GetX(), event.GetY(), event.ControlDown(), event.ShiftDown(), '\0', 0, NULL);
+  NotifyInteraction();
   if(event.GetWheelRotation() > 0)
   {
-    InvokeEvent(vtkCommand::MouseWheelForwardEvent, NULL);
+    DispatchMouseEvent(event, vtkCommand::MouseWheelForwardEvent);
   }
   else
   {
-    InvokeEvent(vtkCommand::MouseWheelBackwardEvent, NULL);
+    DispatchMouseEvent(event, vtkCommand::MouseWheelBackwardEvent);
   }
 
 }
 
 
 void wxVTKRenderWindowInteractor::Render() {
+  EnsureRenderWindow();
+  if (RenderThread.IsRunning()) {
+    if (RenderThread.IsRenderThread()) {
+      // Called by the interactor style while it handles a posted event
+      RenderFrame();
+    }
+    else {
+      // The GUI thread only asks; the render thread draws and presents
+      RenderThread.RequestRender();
+    }
+    return;
+  }
+  if (!wxThread::IsMain()) {
+    // Another window's render thread, e.g. a slice view following a shared cursor
+    CallAfter([this]() { Render(); });
+    return;
+  }
+
   int renderAllowed = 1;
   if (renderAllowed && !RenderWhenDisabled)
   {
@@ -321,18 +571,28 @@ void wxVTKRenderWindowInteractor::Render() {
   {
     if(Handle && (Handle == GetHandleHack()) )
     {
-      RenderWindow->Render();
+      RenderFrame();
     }
     else if(GetHandleHack())
     {
       Handle = GetHandleHack();
       RenderWindow->SetNextWindowId(reinterpret_cast<void *>(Handle));
       RenderWindow->WindowRemap();
-      RenderWindow->Render();
+      RenderFrame();
     }
   }
 }
 
+void wxVTKRenderWindowInteractor::RenderFrame() {
+  // Does nothing after the first frame; renders started elsewhere, like the
+  // tiles of a still, are traced from then on as well
+  wxVTKTrace::InstrumentRenderWindow(RenderWindow);
+  RenderWindow->Render();
+  if (Timeline.FirstFrame < 0) {
+    Timeline.FirstFrame = GetMillisecondsSinceProcessStart();
+  }
+}
+
 void wxVTKRenderWindowInteractor::SetRenderWhenDisabled(int newValue) {
   RenderWhenDisabled = (bool)newValue;
 }
@@ -340,6 +600,7 @@ void wxVTKRenderWindowInteractor::SetRenderWhenDisabled(int newValue) {
 void wxVTKRenderWindowInteractor::SetStereo(int capable) {
   if (Stereo != capable)
   {
+    EnsureRenderWindow();
     Stereo = capable;
     RenderWindow->StereoCapableWindowOn();
     RenderWindow->SetStereoTypeToCrystalEyes();
@@ -349,4 +610,9 @@ void wxVTKRenderWindowInteractor::SetStereo(int capable) {
 
 void wxVTKRenderWindowInteractor::PrintSelf(ostream& os, vtkIndent indent) {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "Startup timeline (ms since process start):\n";
+  os << indent.GetNextIndent() << "Constructed: " << Timeline.Constructed << "\n";
+  os << indent.GetNextIndent() << "FirstPaint: " << Timeline.FirstPaint << "\n";
+  os << indent.GetNextIndent() << "FirstFrame: " << Timeline.FirstFrame << "\n";
+  os << indent.GetNextIndent() << "PipelineReady: " << Timeline.PipelineReady << "\n";
 }
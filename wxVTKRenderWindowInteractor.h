@@ -26,6 +26,9 @@
 #include <vtkRenderWindowInteractor.h>
 #include <vtkRenderWindow.h>
 #include <vtkVersionMacros.h>
+#include <atomic>
+#include <functional>
+#include "wxVTKRenderThread.h"
 
 // wx forward declarations
 class wxPaintEvent;
@@ -33,6 +36,19 @@ class wxMouseEvent;
 class wxTimerEvent;
 class wxKeyEvent;
 class wxSizeEvent;
+class wxIdleEvent;
+class wxVTKFrameCapture;
+class wxVTKResolutionController;
+
+// Milliseconds since process start at which each startup milestone was
+// reached, or -1 if it has not been reached yet. FirstFrame is set by the
+// render thread in threaded mode, hence the atomics.
+struct wxVTKStartupTimeline {
+  std::atomic<double> Constructed{-1.0};
+  std::atomic<double> FirstPaint{-1.0};
+  std::atomic<double> FirstFrame{-1.0};
+  std::atomic<double> PipelineReady{-1.0};
+};
 
 class wxVTKRenderWindowInteractor : public wxWindow, public vtkRenderWindowInteractor{
   DECLARE_DYNAMIC_CLASS(wxVTKRenderWindowInteractor)
@@ -74,6 +90,42 @@ class wxVTKRenderWindowInteractor : public wxWindow, public vtkRenderWindowInter
 
   void OnTimer(wxTimerEvent &event);
   void OnSize(wxSizeEvent &event);
+  void OnIdle(wxIdleEvent &event);
+
+  // The render window and interactor style are created on first use, unless
+  // the caller has set them. A deferred pipeline is built on the first paint
+  // or idle event, so the frame can be shown before any VTK object is constructed.
+  vtkRenderWindow* GetRenderWindow();
+  void SetDeferredPipeline(std::function<void()> builder);
+  const wxVTKStartupTimeline& GetStartupTimeline() const { return Timeline; }
+  static double GetMillisecondsSinceProcessStart();
+
+  // Recording and still export for this window, created on first use
+  wxVTKFrameCapture* GetFrameCapture();
+
+  // Dynamic resolution scaling, created on first use. Input events start an
+  // interaction; RefineDelay milliseconds after the last one the view is
+  // rendered again at native resolution.
+  wxVTKResolutionController* GetResolutionController();
+  vtkSetMacro(RefineDelay, int);
+  vtkGetMacro(RefineDelay, int);
+  void OnRefineTimer(wxTimerEvent &event);
+
+  // Threaded mode: a render thread owns the GL context, input is posted to it
+  // and replayed there, and Render() on the GUI thread only requests a frame.
+  // Scene changes made while it runs must go through RunOnRenderThread().
+  // On X11 the application has to call XInitThreads() before opening the display.
+  void SetThreadedRendering(bool threaded);
+  bool GetThreadedRendering() const { return ThreadedRendering; }
+  // Render back to back instead of on request; threaded mode only
+  void SetContinuousRendering(bool continuous);
+  // Runs the task on the render thread, or right away if there is none
+  void RunOnRenderThread(std::function<void()> task);
+  // Same, but returns only once the task has run
+  void RunOnRenderThreadAndWait(const std::function<void()>& task);
+  // Runs the task on the GUI thread: later through CallAfter() when called
+  // from a render thread, e.g. by an observer, otherwise right away
+  void RunOnGUIThread(std::function<void()> task);
 
   void Render();
   void SetRenderWhenDisabled(int newValue);
@@ -90,6 +142,12 @@ class wxVTKRenderWindowInteractor : public wxWindow, public vtkRenderWindowInter
   int Stereo;
   virtual int InternalCreateTimer(int timerId, int timerType, unsigned long duration);
   virtual int InternalDestroyTimer(int platformTimerId);
+  void EnsureRenderWindow();
+  void BuildDeferredPipeline();
+  void NotifyInteraction();
+  void DispatchMouseEvent(wxMouseEvent &event, unsigned long vtkEvent);
+  void StartRenderThread();
+  void RenderFrame();
 
   private:
 
@@ -97,6 +155,15 @@ class wxVTKRenderWindowInteractor : public wxWindow, public vtkRenderWindowInter
   bool Created;
   int RenderWhenDisabled;
   int UseCaptureMouse;
+  bool Destroying;
+  std::function<void()> DeferredPipeline;
+  wxVTKStartupTimeline Timeline;
+  wxVTKFrameCapture* FrameCapture;
+  wxVTKResolutionController* ResolutionController;
+  wxTimer refineTimer;
+  int RefineDelay;
+  bool ThreadedRendering;
+  wxVTKRenderThread RenderThread;
 
   DECLARE_EVENT_TABLE()
 };
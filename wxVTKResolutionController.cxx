@@ -0,0 +1,274 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+#include "wxVTKResolutionController.h"
+#include <vtkCommand.h>
+#include <vtkObjectFactory.h>
+#include <vtkOpenGLFramebufferObject.h>
+#include <vtkOpenGLQuadHelper.h>
+#include <vtkOpenGLRenderUtilities.h>
+#include <vtkOpenGLRenderWindow.h>
+#include <vtkOpenGLShaderCache.h>
+#include <vtkOpenGLState.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkRendererCollection.h>
+#include <vtkShaderProgram.h>
+#include <vtkTextureObject.h>
+#include <vtk_glew.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Viewports shrink in whole steps, so the reduced size and the texture
+// allocated for it only change when the scale really does
+const double ScaleStep = 1.0 / 16.0;
+
+// Bilinear upscale of the reduced frame followed by an unsharp mask against
+// its four direct neighbours in the source image
+const char* UpscaleFragmentShader = R"(//VTK::System::Dec
+in vec2 texCoord;
+uniform sampler2D source;
+uniform vec2 texelSize;
+uniform float sharpness;
+//VTK::Output::Dec
+void main()
+{
+  vec4 center = texture(source, texCoord);
+  vec4 blur = 0.25 * (texture(source, texCoord + vec2(texelSize.x, 0.0))
+    + texture(source, texCoord - vec2(texelSize.x, 0.0))
+    + texture(source, texCoord + vec2(0.0, texelSize.y))
+    + texture(source, texCoord - vec2(0.0, texelSize.y)));
+  gl_FragData[0] = clamp(center + sharpness * (center - blur), 0.0, 1.0);
+}
+)";
+
+} // namespace
+
+vtkStandardNewMacro(wxVTKResolutionController);
+
+wxVTKResolutionController::wxVTKResolutionController()
+  : RenderWindow(NULL)
+  , StartEventTag(0)
+  , EndEventTag(0)
+  , FrameBudget(16.0)
+  , MinimumScale(0.25)
+  , Sharpness(0.5)
+  , Enabled(true)
+  , Interacting(false)
+  , Scale(1.0)
+  , AppliedScale(1.0)
+  , FrameScale(1.0)
+  , LastFrameTime(0.0)
+  , QuadHelper(NULL)
+{
+}
+
+wxVTKResolutionController::~wxVTKResolutionController() {
+  SetRenderWindow(NULL);
+}
+
+void wxVTKResolutionController::SetRenderWindow(vtkRenderWindow* window) {
+  if (RenderWindow == window) {
+    return;
+  }
+  if (RenderWindow) {
+    RestoreViewports();
+    ReleaseGraphicsResources();
+    RenderWindow->RemoveObserver(StartEventTag);
+    RenderWindow->RemoveObserver(EndEventTag);
+    RenderWindow->UnRegister(this);
+  }
+  RenderWindow = window;
+  if (RenderWindow) {
+    RenderWindow->Register(this);
+    StartEventTag = RenderWindow->AddObserver(vtkCommand::StartEvent, this, &wxVTKResolutionController::OnRenderStart);
+    EndEventTag = RenderWindow->AddObserver(vtkCommand::EndEvent, this, &wxVTKResolutionController::OnRenderEnd);
+  }
+  Modified();
+}
+
+void wxVTKResolutionController::StartInteraction() {
+  Interacting = true;
+}
+
+void wxVTKResolutionController::EndInteraction() {
+  // Keep Scale so the next interaction starts from the last good value
+  Interacting = false;
+}
+
+void wxVTKResolutionController::OnRenderStart() {
+  FrameStart = std::chrono::steady_clock::now();
+  FrameScale = 1.0;
+  if (!Enabled || !Interacting) {
+    return;
+  }
+  // The tiles of a still are rendered at native resolution
+  int* tiles = RenderWindow->GetTileScale();
+  if (tiles[0] > 1 || tiles[1] > 1) {
+    return;
+  }
+  if (std::abs(Scale - AppliedScale) >= ScaleStep) {
+    AppliedScale = std::min(std::round(Scale / ScaleStep) * ScaleStep, 1.0);
+  }
+  if (AppliedScale < 1.0) {
+    ShrinkViewports(AppliedScale);
+  }
+}
+
+void wxVTKResolutionController::OnRenderEnd() {
+  LastFrameTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - FrameStart).count();
+  // Renderers that did not draw still have to get their viewport back
+  RestoreViewports();
+  const double rendered = FrameScale;
+  FrameScale = 1.0;
+  if (!Enabled || !Interacting || LastFrameTime <= 0.0) {
+    return;
+  }
+  // Frame cost is proportional to the pixel count, i.e. to Scale^2. Move half
+  // way to the estimate so a single slow frame does not make the view flicker.
+  double target = rendered * std::sqrt(FrameBudget / LastFrameTime);
+  Scale = std::clamp(0.5 * (Scale + target), MinimumScale, 1.0);
+}
+
+void wxVTKResolutionController::ShrinkViewports(double scale) {
+  vtkRendererCollection* renderers = RenderWindow->GetRenderers();
+  vtkCollectionSimpleIterator rit;
+  renderers->InitTraversal(rit);
+  while (vtkRenderer* renderer = renderers->GetNextRenderer(rit)) {
+    // Overlay layers draw over the upscaled image; selection needs exact pixels
+    if (renderer->GetLayer() != 0 || !renderer->GetDraw() || renderer->GetSelector()) {
+      continue;
+    }
+    ScaledRenderer scaled;
+    scaled.Renderer = renderer;
+    renderer->GetViewport(scaled.Viewport);
+    const double* v = scaled.Viewport;
+    renderer->SetViewport(v[0], v[1], v[0] + (v[2] - v[0]) * scale, v[1] + (v[3] - v[1]) * scale);
+    scaled.EndEventTag = renderer->AddObserver(vtkCommand::EndEvent, this, &wxVTKResolutionController::OnRendererEnd);
+    ScaledRenderers.push_back(scaled);
+  }
+  if (!ScaledRenderers.empty()) {
+    FrameScale = scale;
+  }
+}
+
+void wxVTKResolutionController::RestoreViewports() {
+  for (ScaledRenderer& scaled : ScaledRenderers) {
+    scaled.Renderer->RemoveObserver(scaled.EndEventTag);
+    scaled.Renderer->SetViewport(scaled.Viewport);
+  }
+  ScaledRenderers.clear();
+}
+
+void wxVTKResolutionController::OnRendererEnd(vtkObject* caller, unsigned long, void*) {
+  auto it = std::find_if(ScaledRenderers.begin(), ScaledRenderers.end(),
+    [caller](const ScaledRenderer& scaled) { return scaled.Renderer == caller; });
+  if (it == ScaledRenderers.end()) {
+    return;
+  }
+  vtkRenderer* renderer = it->Renderer;
+  int source[4], target[4];
+  renderer->GetTiledSizeAndOrigin(&source[2], &source[3], &source[0], &source[1]);
+  renderer->RemoveObserver(it->EndEventTag);
+  renderer->SetViewport(it->Viewport);
+  ScaledRenderers.erase(it);
+  renderer->GetTiledSizeAndOrigin(&target[2], &target[3], &target[0], &target[1]);
+  Upscale(source, target);
+}
+
+void wxVTKResolutionController::Upscale(const int source[4], const int target[4]) {
+  // Rectangles are x, y, width, height in window pixels
+  vtkOpenGLRenderWindow* glWindow = vtkOpenGLRenderWindow::SafeDownCast(RenderWindow);
+  if (!glWindow || source[2] <= 0 || source[3] <= 0 || target[2] <= 0 || target[3] <= 0) {
+    return;
+  }
+  vtkOpenGLState* state = glWindow->GetState();
+  if (!ColorTexture) {
+    ColorTexture = vtkSmartPointer<vtkTextureObject>::New();
+    ColorTexture->SetContext(glWindow);
+    ColorTexture->SetMinificationFilter(vtkTextureObject::Linear);
+    ColorTexture->SetMagnificationFilter(vtkTextureObject::Linear);
+    ColorTexture->SetWrapS(vtkTextureObject::ClampToEdge);
+    ColorTexture->SetWrapT(vtkTextureObject::ClampToEdge);
+    Framebuffer = vtkSmartPointer<vtkOpenGLFramebufferObject>::New();
+    Framebuffer->SetContext(glWindow);
+  }
+  if (static_cast<int>(ColorTexture->GetWidth()) != source[2] || static_cast<int>(ColorTexture->GetHeight()) != source[3]) {
+    ColorTexture->Create2D(source[2], source[3], 4, VTK_UNSIGNED_CHAR, false);
+  }
+
+  vtkOpenGLState::ScopedglViewport viewport(state);
+  vtkOpenGLState::ScopedglEnableDisable scissor(state, GL_SCISSOR_TEST);
+  vtkOpenGLState::ScopedglEnableDisable depth(state, GL_DEPTH_TEST);
+  vtkOpenGLState::ScopedglEnableDisable blend(state, GL_BLEND);
+  state->vtkglDisable(GL_SCISSOR_TEST);
+  state->vtkglDisable(GL_DEPTH_TEST);
+  state->vtkglDisable(GL_BLEND);
+
+  // Equal rectangles, so the blit also resolves a multisampled frame
+  state->PushFramebufferBindings();
+  Framebuffer->Bind(GL_DRAW_FRAMEBUFFER);
+  Framebuffer->AddColorAttachment(0, ColorTexture);
+  Framebuffer->ActivateDrawBuffer(0);
+  glWindow->GetRenderFramebuffer()->Bind(GL_READ_FRAMEBUFFER);
+  glWindow->GetRenderFramebuffer()->ActivateReadBuffer(0);
+  glBlitFramebuffer(source[0], source[1], source[0] + source[2], source[1] + source[3],
+    0, 0, source[2], source[3], GL_COLOR_BUFFER_BIT, GL_NEAREST);
+  state->PopFramebufferBindings();
+
+  if (!QuadHelper) {
+    QuadHelper = new vtkOpenGLQuadHelper(glWindow,
+      vtkOpenGLRenderUtilities::GetFullScreenQuadVertexShader().c_str(), UpscaleFragmentShader, "");
+  }
+  else {
+    glWindow->GetShaderCache()->ReadyShaderProgram(QuadHelper->Program);
+  }
+  if (!QuadHelper->Program || !QuadHelper->Program->GetCompiled()) {
+    vtkErrorMacro(<< "Could not build the upscale shader.");
+    return;
+  }
+  state->vtkglViewport(target[0], target[1], target[2], target[3]);
+  ColorTexture->Activate();
+  QuadHelper->Program->SetUniformi("source", ColorTexture->GetTextureUnit());
+  const float texelSize[2] = {1.0f / source[2], 1.0f / source[3]};
+  QuadHelper->Program->SetUniform2f("texelSize", texelSize);
+  QuadHelper->Program->SetUniformf("sharpness", static_cast<float>(Sharpness));
+  QuadHelper->Render();
+  ColorTexture->Deactivate();
+}
+
+void wxVTKResolutionController::ReleaseGraphicsResources() {
+  vtkOpenGLRenderWindow* glWindow = vtkOpenGLRenderWindow::SafeDownCast(RenderWindow);
+  if (!glWindow || (!ColorTexture && !QuadHelper)) {
+    return;
+  }
+  glWindow->MakeCurrent();
+  delete QuadHelper;
+  QuadHelper = NULL;
+  if (ColorTexture) {
+    Framebuffer->ReleaseGraphicsResources(glWindow);
+    ColorTexture->ReleaseGraphicsResources(glWindow);
+  }
+  Framebuffer = NULL;
+  ColorTexture = NULL;
+}
+
+void wxVTKResolutionController::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "RenderWindow: " << RenderWindow << "\n";
+  os << indent << "FrameBudget: " << FrameBudget << "\n";
+  os << indent << "MinimumScale: " << MinimumScale << "\n";
+  os << indent << "Sharpness: " << Sharpness << "\n";
+  os << indent << "Enabled: " << Enabled << "\n";
+  os << indent << "Interacting: " << Interacting << "\n";
+  os << indent << "Scale: " << Scale << "\n";
+  os << indent << "LastFrameTime: " << LastFrameTime << "\n";
+}
@@ -0,0 +1,108 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+// Dynamic resolution scaling for fill-rate bound rendering.
+//
+// While the user interacts, the controller times every frame and picks an
+// image scale for the next one so that it fits the frame budget. Cost grows
+// with the pixel count, so the scale is corrected by the square root of the
+// budget/time ratio. Once interaction stops the interactor renders one more
+// frame at native resolution.
+//
+// A reduced frame is rendered into the lower left part of each layer 0
+// renderer's viewport, so geometry and volumes alike fill fewer pixels. When
+// the renderer has finished, that part is copied to a texture and drawn back
+// over the whole viewport with a bilinear upscale and an unsharp mask.
+// Overlay layers render at native resolution on top. Mapper settings are
+// never changed.
+
+#pragma once
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+#include <chrono>
+#include <vector>
+
+class vtkOpenGLFramebufferObject;
+class vtkOpenGLQuadHelper;
+class vtkRenderWindow;
+class vtkRenderer;
+class vtkTextureObject;
+
+class wxVTKResolutionController : public vtkObject {
+  public:
+  static wxVTKResolutionController* New();
+  vtkTypeMacro(wxVTKResolutionController, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  void SetRenderWindow(vtkRenderWindow* window);
+  vtkGetObjectMacro(RenderWindow, vtkRenderWindow);
+
+  // Target frame time in milliseconds
+  vtkSetClampMacro(FrameBudget, double, 1.0, 1000.0);
+  vtkGetMacro(FrameBudget, double);
+  // Lower bound of the scale, as a fraction of the window's linear size
+  vtkSetClampMacro(MinimumScale, double, 0.05, 1.0);
+  vtkGetMacro(MinimumScale, double);
+  // Strength of the unsharp mask applied by the upscale; 0 is plain bilinear
+  vtkSetClampMacro(Sharpness, double, 0.0, 2.0);
+  vtkGetMacro(Sharpness, double);
+  vtkSetMacro(Enabled, bool);
+  vtkGetMacro(Enabled, bool);
+  vtkBooleanMacro(Enabled, bool);
+
+  void StartInteraction();
+  void EndInteraction();
+  bool IsInteracting() const { return Interacting; }
+
+  vtkGetMacro(Scale, double);
+  vtkGetMacro(LastFrameTime, double);
+
+  protected:
+  wxVTKResolutionController();
+  ~wxVTKResolutionController() override;
+
+  void OnRenderStart();
+  void OnRenderEnd();
+  void OnRendererEnd(vtkObject* caller, unsigned long event, void* data);
+  void ShrinkViewports(double scale);
+  void RestoreViewports();
+  void Upscale(const int source[4], const int target[4]);
+  void ReleaseGraphicsResources();
+
+  // Renderer drawn at reduced size in the frame being rendered
+  struct ScaledRenderer {
+    vtkSmartPointer<vtkRenderer> Renderer;
+    double Viewport[4];
+    unsigned long EndEventTag;
+  };
+
+  vtkRenderWindow* RenderWindow;
+  unsigned long StartEventTag;
+  unsigned long EndEventTag;
+  double FrameBudget;
+  double MinimumScale;
+  double Sharpness;
+  bool Enabled;
+  bool Interacting;
+  double Scale;
+  // Scale rounded to the steps viewports are shrunk in, and that of the current frame
+  double AppliedScale;
+  double FrameScale;
+  double LastFrameTime;
+  std::chrono::steady_clock::time_point FrameStart;
+  std::vector<ScaledRenderer> ScaledRenderers;
+
+  vtkSmartPointer<vtkTextureObject> ColorTexture;
+  vtkSmartPointer<vtkOpenGLFramebufferObject> Framebuffer;
+  vtkOpenGLQuadHelper* QuadHelper;
+
+  private:
+  wxVTKResolutionController(const wxVTKResolutionController&) = delete;
+  void operator=(const wxVTKResolutionController&) = delete;
+};
@@ -0,0 +1,681 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+#include "wxVTKSliceView.h"
+#include "wxVTKRenderWindowInteractor.h"
+#include <vtkCamera.h>
+#include <vtkCommand.h>
+#include <vtkDataArray.h>
+#include <vtkImageActor.h>
+#include <vtkImageData.h>
+#include <vtkImageProperty.h>
+#include <vtkInteractorStyleImage.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkSMPTools.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Copies a slice row by row. A row starts RowStride values after the previous
+// one and its columns are ColumnStride values apart; coronal rows are
+// contiguous runs of the input, sagittal rows step over whole image rows.
+template <typename T>
+struct SliceGatherer {
+  const T* In;
+  T* Out;
+  vtkIdType Columns;
+  vtkIdType ColumnStride;
+  vtkIdType RowStride;
+  int Components;
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    const vtkIdType width = Columns * Components;
+    for (vtkIdType row = begin; row < end; ++row) {
+      const T* src = In + row * RowStride;
+      T* dst = Out + row * width;
+      if (ColumnStride == Components) {
+        std::copy(src, src + width, dst);
+      }
+      else {
+        for (vtkIdType column = 0; column < Columns; ++column) {
+          for (int c = 0; c < Components; ++c) {
+            dst[column * Components + c] = src[column * ColumnStride + c];
+          }
+        }
+      }
+    }
+  }
+};
+
+template <typename T>
+void GatherSlice(const T* in, vtkDataArray* out, vtkIdType columns, vtkIdType rows,
+  vtkIdType columnStride, vtkIdType rowStride, int components)
+{
+  SliceGatherer<T> gatherer{in, static_cast<T*>(out->GetVoidPointer(0)), columns, columnStride, rowStride, components};
+  vtkSMPTools::For(0, rows, gatherer);
+}
+
+// Where the samples of an oblique slice lie. Sample (column, row) is at
+// Start + column * ColumnStep + row * RowStep in continuous index coordinates
+// relative to the first point of the extent.
+struct ObliqueGeometry {
+  vtkIdType Increments[3];
+  double Last[3];
+  int Components;
+  vtkIdType Columns;
+  double Start[3];
+  double ColumnStep[3];
+  double RowStep[3];
+};
+
+// Trilinear resampling into float; samples outside the image are 0. The
+// sample position is computed from the column instead of accumulated, so rows
+// are independent and carry no rounding drift.
+//
+// The samples of a row lie on a line, so the columns inside the image are
+// found analytically and only the columns outside it take a branch: they are
+// zero filled. Inside, the lower corner is clamped one short of the last layer
+// so its upper neighbour always exists, which still interpolates exactly on
+// that layer. Corner indices and weights are computed a block at a time in a
+// loop of 32-bit integer and double arithmetic that vectorises even on SSE2,
+// then the corners are gathered and blended.
+template <typename T>
+struct ObliqueResampler {
+  static constexpr int BlockSize = 256;
+
+  const T* In;
+  float* Out;
+  ObliqueGeometry G;
+
+  bool Inside(const double start[3], vtkIdType column) const {
+    for (int axis = 0; axis < 3; ++axis) {
+      const double x = start[axis] + column * G.ColumnStep[axis];
+      if (x < 0.0 || x > G.Last[axis]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Half-open range of the columns of a row whose samples lie in the image
+  void ClipRow(const double start[3], vtkIdType& first, vtkIdType& last) const {
+    double lo = 0.0;
+    double hi = static_cast<double>(G.Columns - 1);
+    for (int axis = 0; axis < 3; ++axis) {
+      const double s = start[axis];
+      const double d = G.ColumnStep[axis];
+      if (d == 0.0) {
+        if (s < 0.0 || s > G.Last[axis]) {
+          first = last = 0;
+          return;
+        }
+        continue;
+      }
+      double enter = -s / d;
+      double leave = (G.Last[axis] - s) / d;
+      if (d < 0.0) {
+        std::swap(enter, leave);
+      }
+      lo = std::max(lo, enter);
+      hi = std::min(hi, leave);
+    }
+    if (lo > hi) {
+      first = last = 0;
+      return;
+    }
+    first = static_cast<vtkIdType>(std::ceil(lo));
+    last = static_cast<vtkIdType>(std::floor(hi)) + 1;
+    // The divisions may round differently from the positions themselves
+    while (first < last && !Inside(start, first)) {
+      ++first;
+    }
+    while (last > first && !Inside(start, last - 1)) {
+      --last;
+    }
+    if (first < last) {
+      while (first > 0 && Inside(start, first - 1)) {
+        --first;
+      }
+      while (last < G.Columns && Inside(start, last)) {
+        ++last;
+      }
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    const int components = G.Components;
+    int top[3];
+    vtkIdType next[3];
+    for (int axis = 0; axis < 3; ++axis) {
+      top[axis] = std::max(static_cast<int>(G.Last[axis]) - 1, 0);
+      next[axis] = G.Last[axis] > 0.0 ? G.Increments[axis] : 0;
+    }
+    const vtkIdType di = next[0];
+    const vtkIdType dj = next[1];
+    const vtkIdType dk = next[2];
+
+    int ci[BlockSize];
+    int cj[BlockSize];
+    int ck[BlockSize];
+    double fx[BlockSize];
+    double fy[BlockSize];
+    double fz[BlockSize];
+    for (vtkIdType row = begin; row < end; ++row) {
+      const double start[3] = {
+        G.Start[0] + row * G.RowStep[0], G.Start[1] + row * G.RowStep[1], G.Start[2] + row * G.RowStep[2] };
+      float* dst = Out + row * G.Columns * components;
+      vtkIdType first, last;
+      ClipRow(start, first, last);
+      std::fill(dst, dst + first * components, 0.0f);
+      std::fill(dst + last * components, dst + G.Columns * components, 0.0f);
+
+      for (vtkIdType block = first; block < last; block += BlockSize) {
+        const int count = static_cast<int>(std::min<vtkIdType>(BlockSize, last - block));
+        const double column0 = static_cast<double>(block);
+        for (int m = 0; m < count; ++m) {
+          // Same value as a vtkIdType column, but converts from int in vector registers
+          const double column = column0 + m;
+          const double x = start[0] + column * G.ColumnStep[0];
+          const double y = start[1] + column * G.ColumnStep[1];
+          const double z = start[2] + column * G.ColumnStep[2];
+          const int i = std::min(static_cast<int>(x), top[0]);
+          const int j = std::min(static_cast<int>(y), top[1]);
+          const int k = std::min(static_cast<int>(z), top[2]);
+          ci[m] = i;
+          cj[m] = j;
+          ck[m] = k;
+          fx[m] = x - i;
+          fy[m] = y - j;
+          fz[m] = z - k;
+        }
+        float* sample = dst + block * components;
+        for (int m = 0; m < count; ++m) {
+          const T* p = In + ci[m] * G.Increments[0] + cj[m] * G.Increments[1] + ck[m] * G.Increments[2];
+          for (int c = 0; c < components; ++c) {
+            const T* q = p + c;
+            const double v00 = q[0] + fx[m] * (double(q[di]) - q[0]);
+            const double v10 = q[dj] + fx[m] * (double(q[dj + di]) - q[dj]);
+            const double v01 = q[dk] + fx[m] * (double(q[dk + di]) - q[dk]);
+            const double v11 = q[dk + dj] + fx[m] * (double(q[dk + dj + di]) - q[dk + dj]);
+            const double v0 = v00 + fy[m] * (v10 - v00);
+            const double v1 = v01 + fy[m] * (v11 - v01);
+            sample[m * components + c] = static_cast<float>(v0 + fz[m] * (v1 - v0));
+          }
+        }
+      }
+    }
+  }
+};
+
+template <typename T>
+void ResampleSlice(const T* in, vtkDataArray* out, vtkIdType rows, const ObliqueGeometry& geometry) {
+  ObliqueResampler<T> resampler{in, static_cast<float*>(out->GetVoidPointer(0)), geometry};
+  vtkSMPTools::For(0, rows, resampler);
+}
+
+void ClampToBounds(double point[3], const double bounds[6]) {
+  for (int i = 0; i < 3; i++) {
+    point[i] = std::clamp(point[i], bounds[2 * i], bounds[2 * i + 1]);
+  }
+}
+
+double GetSmallestSpacing(vtkImageData* image) {
+  const double* spacing = image->GetSpacing();
+  return std::min({std::fabs(spacing[0]), std::fabs(spacing[1]), std::fabs(spacing[2])});
+}
+
+}
+
+vtkStandardNewMacro(wxVTKSliceCursor);
+
+wxVTKSliceCursor::wxVTKSliceCursor() {
+  Position[0] = Position[1] = Position[2] = 0.0;
+}
+
+wxVTKSliceCursor::~wxVTKSliceCursor() {
+}
+
+void wxVTKSliceCursor::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Position: (" << Position[0] << ", " << Position[1] << ", " << Position[2] << ")\n";
+}
+
+vtkStandardNewMacro(wxVTKSliceView);
+vtkCxxSetObjectMacro(wxVTKSliceView, InputData, vtkImageData);
+
+wxVTKSliceView::wxVTKSliceView()
+  : Interactor(NULL)
+  , InputData(NULL)
+  , Cursor(NULL)
+  , Orientation(Axial)
+  , Output(vtkSmartPointer<vtkImageData>::New())
+  , Actor(vtkSmartPointer<vtkImageActor>::New())
+  , Renderer(vtkSmartPointer<vtkRenderer>::New())
+  , ExtractedInputTime(0)
+  , ExtractedSettingsTime(0)
+  , ExtractedSlice(0)
+  , ExtractedOffset(0.0)
+  , CameraOrientation(-1)
+  , CursorTag(0)
+  , Picking(false)
+{
+  ObliqueNormal[0] = ObliqueNormal[1] = 0.0;
+  ObliqueNormal[2] = 1.0;
+  ObliqueViewUp[0] = ObliqueViewUp[2] = 0.0;
+  ObliqueViewUp[1] = 1.0;
+  Actor->SetInputData(Output);
+  Renderer->AddViewProp(Actor);
+  // Every render of the pane picks up cursor and image changes first
+  RendererTag = Renderer->AddObserver(vtkCommand::StartEvent, this, &wxVTKSliceView::Update);
+}
+
+wxVTKSliceView::~wxVTKSliceView() {
+  Renderer->RemoveObserver(RendererTag);
+  SetInteractor(NULL);
+  SetCursor(NULL);
+  SetInputData(NULL);
+}
+
+void wxVTKSliceView::SetInteractor(wxVTKRenderWindowInteractor* interactor) {
+  if (Interactor == interactor) {
+    return;
+  }
+  if (Interactor) {
+    for (unsigned long tag : InteractorTags) {
+      Interactor->RemoveObserver(tag);
+    }
+    InteractorTags.clear();
+    Interactor->GetRenderWindow()->RemoveRenderer(Renderer);
+  }
+  Interactor = interactor;
+  Picking = false;
+  if (Interactor) {
+    Interactor->GetRenderWindow()->AddRenderer(Renderer);
+    vtkNew<vtkInteractorStyleImage> style;
+    Interactor->SetInteractorStyle(style);
+    // Ahead of the style: the left button places the cursor and the wheel scrolls
+    const float priority = 1.0f;
+    InteractorTags.push_back(Interactor->AddObserver(vtkCommand::LeftButtonPressEvent, this, &wxVTKSliceView::OnLeftButtonPress, priority));
+    InteractorTags.push_back(Interactor->AddObserver(vtkCommand::LeftButtonReleaseEvent, this, &wxVTKSliceView::OnLeftButtonRelease, priority));
+    InteractorTags.push_back(Interactor->AddObserver(vtkCommand::MouseMoveEvent, this, &wxVTKSliceView::OnMouseMove, priority));
+    InteractorTags.push_back(Interactor->AddObserver(vtkCommand::MouseWheelForwardEvent, this, &wxVTKSliceView::OnMouseWheelForward, priority));
+    InteractorTags.push_back(Interactor->AddObserver(vtkCommand::MouseWheelBackwardEvent, this, &wxVTKSliceView::OnMouseWheelBackward, priority));
+  }
+  CameraOrientation = -1;
+  Modified();
+}
+
+void wxVTKSliceView::SetCursor(wxVTKSliceCursor* cursor) {
+  if (Cursor == cursor) {
+    return;
+  }
+  if (Cursor) {
+    Cursor->RemoveObserver(CursorTag);
+    Cursor->UnRegister(this);
+  }
+  Cursor = cursor;
+  if (Cursor) {
+    Cursor->Register(this);
+    CursorTag = Cursor->AddObserver(vtkCommand::ModifiedEvent, this, &wxVTKSliceView::OnCursorModified);
+  }
+  Modified();
+}
+
+void wxVTKSliceView::SetColorWindow(double window) {
+  Actor->GetProperty()->SetColorWindow(window);
+}
+
+double wxVTKSliceView::GetColorWindow() {
+  return Actor->GetProperty()->GetColorWindow();
+}
+
+void wxVTKSliceView::SetColorLevel(double level) {
+  Actor->GetProperty()->SetColorLevel(level);
+}
+
+double wxVTKSliceView::GetColorLevel() {
+  return Actor->GetProperty()->GetColorLevel();
+}
+
+vtkImageData* wxVTKSliceView::GetOutput() {
+  return Output;
+}
+
+vtkImageActor* wxVTKSliceView::GetImageActor() {
+  return Actor;
+}
+
+vtkRenderer* wxVTKSliceView::GetRenderer() {
+  return Renderer;
+}
+
+void wxVTKSliceView::GetPlaneAxes(double u[3], double v[3], double n[3]) {
+  for (int i = 0; i < 3; i++) {
+    u[i] = v[i] = n[i] = 0.0;
+  }
+  switch (Orientation) {
+    case Sagittal:
+      u[1] = v[2] = n[0] = 1.0;
+      return;
+    case Coronal:
+      u[0] = v[2] = 1.0;
+      n[1] = -1.0;
+      return;
+    case Axial:
+      u[0] = v[1] = n[2] = 1.0;
+      return;
+  }
+  n[0] = ObliqueNormal[0];
+  n[1] = ObliqueNormal[1];
+  n[2] = ObliqueNormal[2];
+  if (vtkMath::Normalize(n) == 0.0) {
+    n[2] = 1.0;
+  }
+  // Make the view-up orthogonal to the normal, or pick any perpendicular if it is parallel
+  const double along = vtkMath::Dot(ObliqueViewUp, n);
+  for (int i = 0; i < 3; i++) {
+    v[i] = ObliqueViewUp[i] - along * n[i];
+  }
+  if (vtkMath::Normalize(v) < 1e-6) {
+    vtkMath::Perpendiculars(n, v, NULL, 0.0);
+  }
+  vtkMath::Cross(v, n, u);
+}
+
+void wxVTKSliceView::Update() {
+  if (!InputData || !Cursor) {
+    return;
+  }
+  vtkDataArray* scalars = InputData->GetPointData()->GetScalars();
+  if (!scalars) {
+    return;
+  }
+  if (!scalars->HasStandardMemoryLayout()) {
+    vtkErrorMacro(<< "Update() needs contiguous scalars.");
+    return;
+  }
+  const bool force = InputData->GetMTime() != ExtractedInputTime || GetMTime() != ExtractedSettingsTime;
+  const bool extracted = Orientation == Oblique ? ExtractOblique(force) : ExtractAxisAligned(force);
+  if (!extracted) {
+    return;
+  }
+  ExtractedInputTime = InputData->GetMTime();
+  ExtractedSettingsTime = GetMTime();
+  Output->Modified();
+  if (CameraOrientation != Orientation) {
+    ResetCamera();
+  }
+  else {
+    // The slice moved along the view direction
+    Renderer->ResetCameraClippingRange();
+  }
+}
+
+vtkDataArray* wxVTKSliceView::GetSliceScalars(int type, int components, vtkIdType tuples) {
+  if (!SliceScalars || SliceScalars->GetDataType() != type) {
+    SliceScalars = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(type));
+  }
+  SliceScalars->SetNumberOfComponents(components);
+  SliceScalars->SetNumberOfTuples(tuples);
+  SliceScalars->Modified();
+  return SliceScalars;
+}
+
+bool wxVTKSliceView::ExtractAxisAligned(bool force) {
+  const int axis = Orientation;
+  int extent[6];
+  InputData->GetExtent(extent);
+  const double* origin = InputData->GetOrigin();
+  const double* spacing = InputData->GetSpacing();
+  double position[3];
+  Cursor->GetPosition(position);
+  const int slice = std::clamp(vtkMath::Round((position[axis] - origin[axis]) / spacing[axis]),
+    extent[2 * axis], extent[2 * axis + 1]);
+  if (!force && slice == ExtractedSlice) {
+    return false;
+  }
+  ExtractedSlice = slice;
+
+  vtkDataArray* scalars = InputData->GetPointData()->GetScalars();
+  const int components = scalars->GetNumberOfComponents();
+  const vtkIdType dims[3] = {
+    extent[1] - extent[0] + 1, extent[3] - extent[2] + 1, extent[5] - extent[4] + 1 };
+  const vtkIdType increments[3] = { components, components * dims[0], components * dims[0] * dims[1] };
+  int sliceExtent[6] = { extent[0], extent[1], extent[2], extent[3], extent[4], extent[5] };
+  sliceExtent[2 * axis] = sliceExtent[2 * axis + 1] = slice;
+  Output->SetExtent(sliceExtent);
+  Output->SetOrigin(origin[0], origin[1], origin[2]);
+  Output->SetSpacing(spacing[0], spacing[1], spacing[2]);
+  Actor->SetUserMatrix(NULL);
+
+  const int columnAxis = axis == 0 ? 1 : 0;
+  const int rowAxis = axis == 2 ? 1 : 2;
+  const vtkIdType columns = dims[columnAxis];
+  const vtkIdType rows = dims[rowAxis];
+  const vtkIdType start = (slice - extent[2 * axis]) * increments[axis];
+  if (axis == Axial) {
+    // Axial slices are contiguous: point into the input instead of copying.
+    // SharedScalars keeps the memory alive while the output refers to it.
+    if (!ViewScalars || ViewScalars->GetDataType() != scalars->GetDataType()) {
+      ViewScalars = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(scalars->GetDataType()));
+    }
+    ViewScalars->SetNumberOfComponents(components);
+    ViewScalars->SetVoidArray(scalars->GetVoidPointer(start), columns * rows * components, 1);
+    ViewScalars->Modified();
+    SharedScalars = scalars;
+    Output->GetPointData()->SetScalars(ViewScalars);
+    return true;
+  }
+
+  vtkDataArray* out = GetSliceScalars(scalars->GetDataType(), components, columns * rows);
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(GatherSlice(static_cast<const VTK_TT*>(scalars->GetVoidPointer(start)),
+      out, columns, rows, increments[columnAxis], increments[rowAxis], components));
+    default:
+      vtkErrorMacro(<< "Update() does not support " << scalars->GetDataTypeAsString() << " arrays.");
+      return false;
+  }
+  SharedScalars = NULL;
+  Output->GetPointData()->SetScalars(out);
+  return true;
+}
+
+bool wxVTKSliceView::ExtractOblique(bool force) {
+  double u[3], v[3], n[3];
+  GetPlaneAxes(u, v, n);
+  double bounds[6];
+  InputData->GetBounds(bounds);
+  const double center[3] = {
+    0.5 * (bounds[0] + bounds[1]), 0.5 * (bounds[2] + bounds[3]), 0.5 * (bounds[4] + bounds[5]) };
+  // The plane is centred on the image, so moving the cursor within it changes nothing
+  double position[3];
+  Cursor->GetPosition(position);
+  const double offset = (position[0] - center[0]) * n[0] + (position[1] - center[1]) * n[1] + (position[2] - center[2]) * n[2];
+  if (!force && offset == ExtractedOffset) {
+    return false;
+  }
+  ExtractedOffset = offset;
+
+  // As wide as the image diagonal, so every orientation covers the whole image
+  const double step = GetSmallestSpacing(InputData);
+  const double diagonal = std::sqrt(
+    (bounds[1] - bounds[0]) * (bounds[1] - bounds[0]) +
+    (bounds[3] - bounds[2]) * (bounds[3] - bounds[2]) +
+    (bounds[5] - bounds[4]) * (bounds[5] - bounds[4]));
+  const int size = static_cast<int>(std::ceil(diagonal / step)) + 1;
+  const double half = 0.5 * (size - 1) * step;
+  double planeOrigin[3];
+  for (int i = 0; i < 3; i++) {
+    planeOrigin[i] = center[i] + offset * n[i] - half * (u[i] + v[i]);
+  }
+  Output->SetExtent(0, size - 1, 0, size - 1, 0, 0);
+  Output->SetOrigin(0.0, 0.0, 0.0);
+  Output->SetSpacing(step, step, 1.0);
+
+  vtkDataArray* scalars = InputData->GetPointData()->GetScalars();
+  const int components = scalars->GetNumberOfComponents();
+  int extent[6];
+  InputData->GetExtent(extent);
+  const double* origin = InputData->GetOrigin();
+  const double* spacing = InputData->GetSpacing();
+  ObliqueGeometry geometry;
+  geometry.Components = components;
+  geometry.Columns = size;
+  for (int i = 0; i < 3; i++) {
+    geometry.Last[i] = extent[2 * i + 1] - extent[2 * i];
+    geometry.Start[i] = (planeOrigin[i] - origin[i]) / spacing[i] - extent[2 * i];
+    geometry.ColumnStep[i] = step * u[i] / spacing[i];
+    geometry.RowStep[i] = step * v[i] / spacing[i];
+  }
+  geometry.Increments[0] = components;
+  geometry.Increments[1] = geometry.Increments[0] * (extent[1] - extent[0] + 1);
+  geometry.Increments[2] = geometry.Increments[1] * (extent[3] - extent[2] + 1);
+
+  vtkDataArray* out = GetSliceScalars(VTK_FLOAT, components, vtkIdType(size) * size);
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(ResampleSlice(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)), out, size, geometry));
+    default:
+      vtkErrorMacro(<< "Update() does not support " << scalars->GetDataTypeAsString() << " arrays.");
+      return false;
+  }
+  SharedScalars = NULL;
+  Output->GetPointData()->SetScalars(out);
+
+  // Places the resampled image on its plane
+  vtkNew<vtkMatrix4x4> matrix;
+  for (int i = 0; i < 3; i++) {
+    matrix->SetElement(i, 0, u[i]);
+    matrix->SetElement(i, 1, v[i]);
+    matrix->SetElement(i, 2, n[i]);
+    matrix->SetElement(i, 3, planeOrigin[i]);
+  }
+  Actor->SetUserMatrix(matrix);
+  return true;
+}
+
+void wxVTKSliceView::ResetCamera() {
+  double u[3], v[3], n[3];
+  GetPlaneAxes(u, v, n);
+  const double* bounds = Actor->GetBounds();
+  const double center[3] = {
+    0.5 * (bounds[0] + bounds[1]), 0.5 * (bounds[2] + bounds[3]), 0.5 * (bounds[4] + bounds[5]) };
+  vtkCamera* camera = Renderer->GetActiveCamera();
+  camera->ParallelProjectionOn();
+  camera->SetFocalPoint(center[0], center[1], center[2]);
+  camera->SetPosition(center[0] + n[0], center[1] + n[1], center[2] + n[2]);
+  camera->SetViewUp(v);
+  Renderer->ResetCamera();
+  CameraOrientation = Orientation;
+}
+
+void wxVTKSliceView::Scroll(int slices) {
+  if (!InputData || !Cursor) {
+    return;
+  }
+  double u[3], v[3], n[3];
+  GetPlaneAxes(u, v, n);
+  const double step = Orientation == Oblique ? GetSmallestSpacing(InputData) : std::fabs(InputData->GetSpacing()[Orientation]);
+  double position[3];
+  Cursor->GetPosition(position);
+  for (int i = 0; i < 3; i++) {
+    position[i] += slices * step * n[i];
+  }
+  double bounds[6];
+  InputData->GetBounds(bounds);
+  ClampToBounds(position, bounds);
+  Cursor->SetPosition(position);
+}
+
+void wxVTKSliceView::PickCursor() {
+  if (!InputData || !Cursor) {
+    return;
+  }
+  const int* event = Interactor->GetEventPosition();
+  Renderer->SetDisplayPoint(event[0], event[1], 0.0);
+  Renderer->DisplayToWorld();
+  double world[4];
+  Renderer->GetWorldPoint(world);
+  if (world[3] != 0.0) {
+    for (int i = 0; i < 3; i++) {
+      world[i] /= world[3];
+    }
+  }
+  // Slide the point along the view direction onto the cursor's plane, so only
+  // its in-plane coordinates change and this view keeps its slice
+  double u[3], v[3], n[3];
+  GetPlaneAxes(u, v, n);
+  double position[3];
+  Cursor->GetPosition(position);
+  const double along = (world[0] - position[0]) * n[0] + (world[1] - position[1]) * n[1] + (world[2] - position[2]) * n[2];
+  for (int i = 0; i < 3; i++) {
+    position[i] = world[i] - along * n[i];
+  }
+  double bounds[6];
+  InputData->GetBounds(bounds);
+  ClampToBounds(position, bounds);
+  Cursor->SetPosition(position);
+}
+
+void wxVTKSliceView::OnCursorModified() {
+  if (Interactor) {
+    Interactor->Render();
+  }
+}
+
+bool wxVTKSliceView::OnLeftButtonPress(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), void* vtkNotUsed(data)) {
+  Picking = true;
+  PickCursor();
+  return true;
+}
+
+bool wxVTKSliceView::OnLeftButtonRelease(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), void* vtkNotUsed(data)) {
+  if (!Picking) {
+    return false;
+  }
+  Picking = false;
+  return true;
+}
+
+bool wxVTKSliceView::OnMouseMove(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), void* vtkNotUsed(data)) {
+  if (!Picking) {
+    return false;
+  }
+  PickCursor();
+  return true;
+}
+
+bool wxVTKSliceView::OnMouseWheelForward(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), void* vtkNotUsed(data)) {
+  Scroll(1);
+  return true;
+}
+
+bool wxVTKSliceView::OnMouseWheelBackward(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(event), void* vtkNotUsed(data)) {
+  Scroll(-1);
+  return true;
+}
+
+void wxVTKSliceView::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  static const char* names[] = { "Sagittal", "Coronal", "Axial", "Oblique" };
+  os << indent << "Orientation: " << names[Orientation] << "\n";
+  os << indent << "Interactor: " << static_cast<void*>(Interactor) << "\n";
+  os << indent << "InputData: " << InputData << "\n";
+  os << indent << "Cursor: " << Cursor << "\n";
+  os << indent << "ObliqueNormal: (" << ObliqueNormal[0] << ", " << ObliqueNormal[1] << ", " << ObliqueNormal[2] << ")\n";
+  os << indent << "ObliqueViewUp: (" << ObliqueViewUp[0] << ", " << ObliqueViewUp[1] << ", " << ObliqueViewUp[2] << ")\n";
+  os << indent << "ExtractedSlice: " << ExtractedSlice << "\n";
+  os << indent << "SharesInputMemory: " << (SharedScalars ? "On" : "Off") << "\n";
+}
@@ -0,0 +1,161 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+// Multi-planar reformatting: slice views through a shared vtkImageData.
+//
+// Each wxVTKSliceView shows one plane of the image in its own
+// wxVTKRenderWindowInteractor. Views of the same image share a
+// wxVTKSliceCursor; clicking or dragging in one view moves the cursor and the
+// other views follow, the mouse wheel scrolls through slices. A view only
+// re-extracts its slice when the cursor leaves the current slice or the image
+// changes. Axial slices are contiguous in memory and are displayed without a
+// copy, coronal and sagittal slices are gathered row by row, and oblique
+// slices are resampled with trilinear interpolation; the latter two run in
+// parallel with vtkSMPTools.
+//
+// The views render each other from the cursor's observers, so their panes
+// must not use threaded rendering.
+
+#pragma once
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+#include <vector>
+
+class vtkDataArray;
+class vtkImageActor;
+class vtkImageData;
+class vtkRenderer;
+class wxVTKRenderWindowInteractor;
+
+// Shared point of interest in world coordinates. Setting it invokes ModifiedEvent.
+class wxVTKSliceCursor : public vtkObject {
+  public:
+  static wxVTKSliceCursor* New();
+  vtkTypeMacro(wxVTKSliceCursor, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  vtkSetVector3Macro(Position, double);
+  vtkGetVector3Macro(Position, double);
+
+  protected:
+  wxVTKSliceCursor();
+  ~wxVTKSliceCursor() override;
+
+  double Position[3];
+
+  private:
+  wxVTKSliceCursor(const wxVTKSliceCursor&) = delete;
+  void operator=(const wxVTKSliceCursor&) = delete;
+};
+
+class wxVTKSliceView : public vtkObject {
+  public:
+  static wxVTKSliceView* New();
+  vtkTypeMacro(wxVTKSliceView, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  // The values of the axis-aligned orientations are the index of their normal axis
+  enum {
+    Sagittal = 0,
+    Coronal = 1,
+    Axial = 2,
+    Oblique = 3
+  };
+
+  // The pane to draw into. The view adds its own renderer and image interactor
+  // style; release the view or set NULL before the pane is destroyed.
+  void SetInteractor(wxVTKRenderWindowInteractor* interactor);
+  wxVTKRenderWindowInteractor* GetInteractor() { return Interactor; }
+  void SetInputData(vtkImageData* image);
+  vtkGetObjectMacro(InputData, vtkImageData);
+  void SetCursor(wxVTKSliceCursor* cursor);
+  vtkGetObjectMacro(Cursor, wxVTKSliceCursor);
+
+  vtkSetClampMacro(Orientation, int, Sagittal, Oblique);
+  vtkGetMacro(Orientation, int);
+  void SetOrientationToSagittal() { SetOrientation(Sagittal); }
+  void SetOrientationToCoronal() { SetOrientation(Coronal); }
+  void SetOrientationToAxial() { SetOrientation(Axial); }
+  void SetOrientationToOblique() { SetOrientation(Oblique); }
+
+  // Plane normal and view-up of the oblique orientation, in world coordinates
+  vtkSetVector3Macro(ObliqueNormal, double);
+  vtkGetVector3Macro(ObliqueNormal, double);
+  vtkSetVector3Macro(ObliqueViewUp, double);
+  vtkGetVector3Macro(ObliqueViewUp, double);
+
+  void SetColorWindow(double window);
+  double GetColorWindow();
+  void SetColorLevel(double level);
+  double GetColorLevel();
+
+  // Moves the cursor by whole slices along the view normal
+  void Scroll(int slices);
+  // Re-extracts the slice if the cursor left it or the image changed. Runs
+  // automatically at the start of every render of the pane.
+  void Update();
+  // Looks at the slice along its normal, with parallel projection
+  void ResetCamera();
+
+  vtkImageData* GetOutput();
+  vtkImageActor* GetImageActor();
+  vtkRenderer* GetRenderer();
+
+  protected:
+  wxVTKSliceView();
+  ~wxVTKSliceView() override;
+
+  // Unit in-plane axes and normal of the current orientation, with u x v = n
+  void GetPlaneAxes(double u[3], double v[3], double n[3]);
+  // Return whether the output changed
+  bool ExtractAxisAligned(bool force);
+  bool ExtractOblique(bool force);
+  vtkDataArray* GetSliceScalars(int type, int components, vtkIdType tuples);
+  void PickCursor();
+
+  void OnCursorModified();
+  // Return true to keep the event from the interactor style
+  bool OnLeftButtonPress(vtkObject* caller, unsigned long event, void* data);
+  bool OnLeftButtonRelease(vtkObject* caller, unsigned long event, void* data);
+  bool OnMouseMove(vtkObject* caller, unsigned long event, void* data);
+  bool OnMouseWheelForward(vtkObject* caller, unsigned long event, void* data);
+  bool OnMouseWheelBackward(vtkObject* caller, unsigned long event, void* data);
+
+  wxVTKRenderWindowInteractor* Interactor;
+  vtkImageData* InputData;
+  wxVTKSliceCursor* Cursor;
+  int Orientation;
+  double ObliqueNormal[3];
+  double ObliqueViewUp[3];
+
+  vtkSmartPointer<vtkImageData> Output;
+  vtkSmartPointer<vtkImageActor> Actor;
+  vtkSmartPointer<vtkRenderer> Renderer;
+  // Owned buffer for gathered and resampled slices
+  vtkSmartPointer<vtkDataArray> SliceScalars;
+  // View into the input's memory for axial slices, and the array it points into
+  vtkSmartPointer<vtkDataArray> ViewScalars;
+  vtkSmartPointer<vtkDataArray> SharedScalars;
+
+  // What the current output was extracted from
+  vtkMTimeType ExtractedInputTime;
+  vtkMTimeType ExtractedSettingsTime;
+  int ExtractedSlice;
+  double ExtractedOffset;
+  int CameraOrientation;
+
+  unsigned long CursorTag;
+  unsigned long RendererTag;
+  std::vector<unsigned long> InteractorTags;
+  bool Picking;
+
+  private:
+  wxVTKSliceView(const wxVTKSliceView&) = delete;
+  void operator=(const wxVTKSliceView&) = delete;
+};
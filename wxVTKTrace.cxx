@@ -0,0 +1,346 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+#include "wxVTKTrace.h"
+#include "wxVTKPipeline.h"
+#include <vtkAlgorithm.h>
+#include <vtkCommand.h>
+#include <vtkDemandDrivenPipeline.h>
+#include <vtkNew.h>
+#include <vtkProp.h>
+#include <vtkPropCollection.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkRendererCollection.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct TraceEvent {
+  const char* Name;
+  const char* Category;
+  char Phase;
+  double Timestamp;
+  double Duration;
+};
+
+// Written only by its own thread; Count is published with release semantics
+// so the writer of the trace sees complete events.
+struct ThreadBuffer {
+  std::vector<TraceEvent> Events;
+  std::atomic<size_t> Count{0};
+  std::atomic<size_t> Dropped{0};
+  int Thread;
+};
+
+struct Registry {
+  std::mutex Mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> Buffers;
+  // Buffers of exited threads, handed to the next thread that traces
+  std::vector<ThreadBuffer*> Retired;
+  size_t Capacity = 1 << 16;
+  int Threads = 0;
+  std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+};
+
+// Never destroyed, so threads still tracing during static destruction are safe
+Registry& GetRegistry() {
+  static Registry* registry = new Registry;
+  return *registry;
+}
+
+// Retires the buffer of a thread when the thread exits
+struct BufferLease {
+  ThreadBuffer* Buffer = nullptr;
+
+  ~BufferLease() {
+    if (Buffer) {
+      Registry& registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.Mutex);
+      registry.Retired.push_back(Buffer);
+    }
+  }
+};
+
+// Takes a retired buffer if there is one, so threads that come and go, like
+// the render thread of the interactor, do not add a buffer each time. The new
+// thread appends after the events already in it and shows up under the same
+// thread id.
+ThreadBuffer* GetThreadBuffer() {
+  thread_local BufferLease lease;
+  if (!lease.Buffer) {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.Mutex);
+    if (!registry.Retired.empty()) {
+      lease.Buffer = registry.Retired.back();
+      registry.Retired.pop_back();
+    }
+    else {
+      std::unique_ptr<ThreadBuffer> created(new ThreadBuffer);
+      created->Events.resize(registry.Capacity);
+      created->Thread = ++registry.Threads;
+      lease.Buffer = created.get();
+      registry.Buffers.push_back(std::move(created));
+    }
+  }
+  return lease.Buffer;
+}
+
+void Record(const TraceEvent& event) {
+  ThreadBuffer* buffer = GetThreadBuffer();
+  size_t count = buffer->Count.load(std::memory_order_relaxed);
+  if (count >= buffer->Events.size()) {
+    buffer->Dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  buffer->Events[count] = event;
+  buffer->Count.store(count + 1, std::memory_order_release);
+}
+
+void WriteString(ostream& os, const char* text) {
+  os << '"';
+  for (const char* c = text; c && *c; ++c) {
+    if (*c == '"' || *c == '\\') {
+      os << '\\';
+    }
+    os << *c;
+  }
+  os << '"';
+}
+
+// Brackets the execution of the algorithm it observes
+class TraceCommand : public vtkCommand {
+  public:
+  static TraceCommand* New() { return new TraceCommand; }
+  vtkTypeMacro(TraceCommand, vtkCommand);
+
+  void Execute(vtkObject* caller, unsigned long eventId, void* vtkNotUsed(callData)) override {
+    if (!wxVTKTrace::IsEnabled()) {
+      return;
+    }
+    if (eventId == vtkCommand::StartEvent) {
+      wxVTKTrace::Begin(caller->GetClassName(), "filter");
+    }
+    else if (eventId == vtkCommand::EndEvent) {
+      wxVTKTrace::End(caller->GetClassName(), "filter");
+    }
+  }
+};
+
+TraceCommand* GetTraceCommand() {
+  static vtkNew<TraceCommand> command;
+  return command;
+}
+
+void InstrumentAlgorithm(vtkAlgorithm* algorithm) {
+  if (!algorithm) {
+    return;
+  }
+  if (!algorithm->HasObserver(vtkCommand::StartEvent, GetTraceCommand())) {
+    algorithm->AddObserver(vtkCommand::StartEvent, GetTraceCommand());
+    algorithm->AddObserver(vtkCommand::EndEvent, GetTraceCommand());
+  }
+  // Producers may have been connected upstream of an instrumented algorithm
+  wxVTKPipeline::ForEachProducer(algorithm, InstrumentAlgorithm);
+}
+
+// Advances when props are added or removed, a prop or mapper is modified, or
+// the pipeline feeding a mapper is modified or rewired. Only looks one step
+// upstream of each mapper: the executive's pipeline time covers the rest.
+vtkMTimeType GetPipelineTime(vtkRenderWindow* window) {
+  vtkRendererCollection* renderers = window->GetRenderers();
+  vtkMTimeType time = renderers->GetMTime();
+  vtkCollectionSimpleIterator rit;
+  renderers->InitTraversal(rit);
+  while (vtkRenderer* renderer = renderers->GetNextRenderer(rit)) {
+    time = std::max(time, renderer->GetViewProps()->GetMTime());
+  }
+  wxVTKPipeline::ForEachProp(window, [&time](vtkProp* prop) {
+    time = std::max(time, prop->GetMTime());
+    vtkAlgorithm* mapper = wxVTKPipeline::GetMapper(prop);
+    if (!mapper) {
+      return;
+    }
+    time = std::max(time, mapper->GetMTime());
+    wxVTKPipeline::ForEachProducer(mapper, [&time](vtkAlgorithm* producer) {
+      time = std::max(time, producer->GetMTime());
+      if (vtkDemandDrivenPipeline* executive = vtkDemandDrivenPipeline::SafeDownCast(producer->GetExecutive())) {
+        time = std::max(time, executive->GetPipelineMTime());
+      }
+    });
+  });
+  return time;
+}
+
+// Brackets the renders of the windows it observes, and instruments their
+// pipelines again when they have changed since the last traced render
+class RenderTraceCommand : public vtkCommand {
+  public:
+  static RenderTraceCommand* New() { return new RenderTraceCommand; }
+  vtkTypeMacro(RenderTraceCommand, vtkCommand);
+
+  void Execute(vtkObject* caller, unsigned long eventId, void* vtkNotUsed(callData)) override {
+    vtkRenderWindow* window = static_cast<vtkRenderWindow*>(caller);
+    if (eventId == vtkCommand::DeleteEvent) {
+      std::lock_guard<std::mutex> lock(Mutex);
+      InstrumentedTimes.erase(window);
+      return;
+    }
+    if (!wxVTKTrace::IsEnabled()) {
+      return;
+    }
+    if (eventId == vtkCommand::StartEvent) {
+      Instrument(window);
+      wxVTKTrace::Begin("vtkRenderWindow::Render", "render");
+    }
+    else if (eventId == vtkCommand::EndEvent) {
+      wxVTKTrace::End("vtkRenderWindow::Render", "render");
+    }
+  }
+
+  private:
+  void Instrument(vtkRenderWindow* window) {
+    const vtkMTimeType time = GetPipelineTime(window);
+    // Windows may render on different threads and share algorithms
+    std::lock_guard<std::mutex> lock(Mutex);
+    vtkMTimeType& instrumented = InstrumentedTimes[window];
+    if (time <= instrumented) {
+      return;
+    }
+    instrumented = time;
+    wxVTKPipeline::ForEachProp(window, [](vtkProp* prop) { InstrumentAlgorithm(wxVTKPipeline::GetMapper(prop)); });
+  }
+
+  std::mutex Mutex;
+  std::unordered_map<vtkRenderWindow*, vtkMTimeType> InstrumentedTimes;
+};
+
+RenderTraceCommand* GetRenderTraceCommand() {
+  static vtkNew<RenderTraceCommand> command;
+  return command;
+}
+
+}
+
+void wxVTKTrace::SetEnabled(bool enabled) {
+  // Fixes the epoch before the first event
+  GetRegistry();
+  Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void wxVTKTrace::SetBufferCapacity(size_t events) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.Mutex);
+  registry.Capacity = events;
+}
+
+double wxVTKTrace::Now() {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - GetRegistry().Epoch).count();
+}
+
+void wxVTKTrace::Begin(const char* name, const char* category) {
+  if (IsEnabled()) {
+    Record({name, category, 'B', Now(), 0.0});
+  }
+}
+
+void wxVTKTrace::End(const char* name, const char* category) {
+  if (IsEnabled()) {
+    Record({name, category, 'E', Now(), 0.0});
+  }
+}
+
+void wxVTKTrace::Complete(const char* name, const char* category, double start, double duration) {
+  if (IsEnabled()) {
+    Record({name, category, 'X', start, duration});
+  }
+}
+
+void wxVTKTrace::InstrumentRenderWindow(vtkRenderWindow* window) {
+  RenderTraceCommand* command = GetRenderTraceCommand();
+  if (!window || window->HasObserver(vtkCommand::StartEvent, command)) {
+    return;
+  }
+  window->AddObserver(vtkCommand::StartEvent, command);
+  window->AddObserver(vtkCommand::EndEvent, command);
+  window->AddObserver(vtkCommand::DeleteEvent, command);
+}
+
+void wxVTKTrace::WriteChromeTrace(ostream& os) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.Mutex);
+
+  std::streamsize precision = os.precision(15);
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const std::unique_ptr<ThreadBuffer>& buffer : registry.Buffers) {
+    os << (first ? "\n" : ",\n");
+    first = false;
+    os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->Thread
+       << ",\"args\":{\"name\":\"thread " << buffer->Thread << "\"}}";
+
+    size_t count = buffer->Count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+      const TraceEvent& event = buffer->Events[i];
+      os << ",\n{\"name\":";
+      WriteString(os, event.Name);
+      os << ",\"cat\":";
+      WriteString(os, event.Category);
+      os << ",\"ph\":\"" << event.Phase << "\",\"pid\":1,\"tid\":" << buffer->Thread
+         << ",\"ts\":" << event.Timestamp;
+      if (event.Phase == 'X') {
+        os << ",\"dur\":" << event.Duration;
+      }
+      os << "}";
+    }
+  }
+  os << "\n]}\n";
+  os.precision(precision);
+}
+
+bool wxVTKTrace::WriteChromeTrace(const std::string& filename) {
+  std::ofstream file(filename);
+  if (!file) {
+    return false;
+  }
+  WriteChromeTrace(file);
+  return static_cast<bool>(file);
+}
+
+void wxVTKTrace::Clear() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.Mutex);
+  // Buffers of exited threads are freed; the live threads keep theirs
+  auto retired = [&registry](const std::unique_ptr<ThreadBuffer>& buffer) {
+    return std::find(registry.Retired.begin(), registry.Retired.end(), buffer.get()) != registry.Retired.end();
+  };
+  registry.Buffers.erase(std::remove_if(registry.Buffers.begin(), registry.Buffers.end(), retired),
+    registry.Buffers.end());
+  registry.Retired.clear();
+  for (const std::unique_ptr<ThreadBuffer>& buffer : registry.Buffers) {
+    buffer->Count.store(0, std::memory_order_relaxed);
+    buffer->Dropped.store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t wxVTKTrace::GetNumberOfDroppedEvents() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.Mutex);
+  size_t dropped = 0;
+  for (const std::unique_ptr<ThreadBuffer>& buffer : registry.Buffers) {
+    dropped += buffer->Dropped.load(std::memory_order_relaxed);
+  }
+  return dropped;
+}
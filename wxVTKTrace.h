@@ -0,0 +1,81 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+// Runtime-switchable tracing of wx events, filter execution and renders,
+// exported as Chrome trace JSON (open it in Perfetto or chrome://tracing).
+//
+// Every thread appends to its own fixed-size buffer without locking; the only
+// lock is taken once per thread to register its buffer. When a buffer is full
+// further events of that thread are dropped and counted. A buffer is only
+// allocated once its thread records an event, which needs tracing to be on.
+// When the thread exits, the next new thread reuses the buffer, and Clear()
+// frees buffers that no live thread holds. While tracing is off a span costs
+// one relaxed atomic load.
+
+#pragma once
+#include <vtkIOStream.h>
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+class vtkRenderWindow;
+
+class wxVTKTrace {
+  public:
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled() { return Enabled.load(std::memory_order_relaxed); }
+
+  // Events per thread; applies to buffers allocated from now on, not to reused ones
+  static void SetBufferCapacity(size_t events);
+
+  // Microseconds since tracing was first enabled
+  static double Now();
+
+  // Names and categories must outlive the trace, e.g. string literals or class names
+  static void Begin(const char* name, const char* category);
+  static void End(const char* name, const char* category);
+  static void Complete(const char* name, const char* category, double start, double duration);
+
+  // Traces every render of the window, whoever starts it. While tracing is on,
+  // a render first adds StartEvent/EndEvent observers to the algorithms
+  // feeding the props of the window, but only when the props or their
+  // pipelines have been modified since the last traced render. Calling this
+  // again for the same window does nothing.
+  static void InstrumentRenderWindow(vtkRenderWindow* window);
+
+  // Only call these while tracing is disabled
+  static void WriteChromeTrace(ostream& os);
+  static bool WriteChromeTrace(const std::string& filename);
+  static void Clear();
+
+  static size_t GetNumberOfDroppedEvents();
+
+  private:
+  static inline std::atomic<bool> Enabled{false};
+};
+
+// Records a complete span from construction to destruction
+class wxVTKTraceScope {
+  public:
+  explicit wxVTKTraceScope(const char* name, const char* category = "wx")
+    : Name(name), Category(category), Start(wxVTKTrace::IsEnabled() ? wxVTKTrace::Now() : -1.0) {}
+  ~wxVTKTraceScope() {
+    if (Start >= 0.0) {
+      wxVTKTrace::Complete(Name, Category, Start, wxVTKTrace::Now() - Start);
+    }
+  }
+
+  private:
+  wxVTKTraceScope(const wxVTKTraceScope&) = delete;
+  void operator=(const wxVTKTraceScope&) = delete;
+
+  const char* Name;
+  const char* Category;
+  double Start;
+};
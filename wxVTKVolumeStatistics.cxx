@@ -0,0 +1,265 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+#include "wxVTKVolumeStatistics.h"
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+namespace {
+
+// Per-thread partial histograms over [Min, Min + Bins / Scale], summed in
+// Reduce(). Bin indices are computed a block at a time with selects only, so
+// that loop vectorises; the increments are a scatter and stay scalar. NaNs go
+// to an extra bin past the end that is not reported.
+template <typename T>
+struct HistogramWorker {
+  const T* Data;
+  int Stride;
+  double Min;
+  double Scale;
+  int Bins;
+  vtkSMPThreadLocal<std::vector<vtkIdType>> Local;
+  std::vector<vtkIdType> Result;
+
+  HistogramWorker(const T* data, int stride, double min, double scale, int bins)
+    : Data(data), Stride(stride), Min(min), Scale(scale), Bins(bins) {}
+
+  void Initialize() {
+    Local.Local().assign(Bins + 1, 0);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    vtkIdType* counts = Local.Local().data();
+    const double last = Bins - 1;
+    const double nanBin = Bins;
+    int bins[BlockSize];
+    for (vtkIdType block = begin; block < end; block += BlockSize) {
+      const int n = static_cast<int>(std::min<vtkIdType>(BlockSize, end - block));
+      const T* values = Data + block * Stride;
+      for (int i = 0; i < n; ++i) {
+        const double v = static_cast<double>(values[i * Stride]);
+        double b = (v - Min) * Scale;
+        b = b < 0.0 ? 0.0 : b;
+        b = b > last ? last : b;
+        // NaN fails both clamps; move it to its own bin before the conversion
+        b = v == v ? b : nanBin;
+        bins[i] = static_cast<int>(b);
+      }
+      for (int i = 0; i < n; ++i) {
+        ++counts[bins[i]];
+      }
+    }
+  }
+
+  static constexpr int BlockSize = 1024;
+
+  void Reduce() {
+    Result.assign(Bins, 0);
+    for (auto it = Local.begin(); it != Local.end(); ++it) {
+      for (int b = 0; b < Bins; ++b) {
+        Result[b] += (*it)[b];
+      }
+    }
+  }
+};
+
+// Single pass for 8- and 16-bit integers: count every value of the domain
+template <typename T>
+struct DomainWorker {
+  const T* Data;
+  int Stride;
+  vtkSMPThreadLocal<std::vector<vtkIdType>> Local;
+  std::vector<vtkIdType> Result;
+
+  static constexpr int DomainSize = 1 << (8 * sizeof(T));
+  static constexpr int Offset = -static_cast<int>(std::numeric_limits<T>::min());
+
+  DomainWorker(const T* data, int stride) : Data(data), Stride(stride) {}
+
+  void Initialize() {
+    Local.Local().assign(DomainSize, 0);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end) {
+    vtkIdType* counts = Local.Local().data();
+    for (vtkIdType i = begin; i < end; ++i) {
+      ++counts[static_cast<int>(Data[i * Stride]) + Offset];
+    }
+  }
+
+  void Reduce() {
+    Result.assign(DomainSize, 0);
+    for (auto it = Local.begin(); it != Local.end(); ++it) {
+      for (int v = 0; v < DomainSize; ++v) {
+        Result[v] += (*it)[v];
+      }
+    }
+  }
+};
+
+template <typename T>
+void ComputeStatistics(vtkDataArray* array, const T* data, vtkIdType count, int stride, int component, int bins,
+  double range[2], std::vector<vtkIdType>& histogram) {
+  histogram.assign(bins, 0);
+  range[0] = range[1] = 0.0;
+
+  if constexpr (std::is_integral_v<T> && sizeof(T) <= 2) {
+    DomainWorker<T> domain(data, stride);
+    vtkSMPTools::For(0, count, domain);
+
+    int lo = 0;
+    int hi = DomainWorker<T>::DomainSize - 1;
+    while (lo <= hi && domain.Result[lo] == 0) {
+      ++lo;
+    }
+    while (hi >= lo && domain.Result[hi] == 0) {
+      --hi;
+    }
+    if (lo > hi) {
+      return;
+    }
+    range[0] = lo - DomainWorker<T>::Offset;
+    range[1] = hi - DomainWorker<T>::Offset;
+    const double scale = range[1] > range[0] ? bins / (range[1] - range[0]) : 0.0;
+    for (int v = lo; v <= hi; ++v) {
+      int bin = std::min(static_cast<int>((v - lo) * scale), bins - 1);
+      histogram[bin] += domain.Result[v];
+    }
+  }
+  else {
+    // vtkDataArray caches its range on its MTime, so this scans the data only
+    // if nobody has asked for the range since it last changed
+    array->GetRange(range, component);
+    if (!(range[0] <= range[1])) {
+      // Only NaNs
+      range[0] = range[1] = 0.0;
+      return;
+    }
+
+    const double scale = range[1] > range[0] ? bins / (range[1] - range[0]) : 0.0;
+    HistogramWorker<T> counter(data, stride, range[0], scale, bins);
+    vtkSMPTools::For(0, count, counter);
+    histogram.swap(counter.Result);
+  }
+}
+
+}
+
+vtkStandardNewMacro(wxVTKVolumeStatistics);
+
+wxVTKVolumeStatistics::wxVTKVolumeStatistics()
+  : NumberOfBins(256)
+  , Component(0)
+  , Range{0.0, 0.0}
+  , Total(0)
+  , CachedArray(NULL)
+  , CachedArrayTime(0)
+  , CachedSettingsTime(0)
+{
+}
+
+wxVTKVolumeStatistics::~wxVTKVolumeStatistics() = default;
+
+void wxVTKVolumeStatistics::SetInputData(vtkImageData* image) {
+  SetInputArray(image ? image->GetPointData()->GetScalars() : NULL);
+}
+
+void wxVTKVolumeStatistics::SetInputArray(vtkDataArray* array) {
+  if (InputArray == array) {
+    return;
+  }
+  InputArray = array;
+  Modified();
+}
+
+vtkDataArray* wxVTKVolumeStatistics::GetInputArray() {
+  return InputArray;
+}
+
+void wxVTKVolumeStatistics::Update() {
+  vtkDataArray* array = InputArray;
+  if (array == CachedArray && (!array || array->GetMTime() == CachedArrayTime) && GetMTime() == CachedSettingsTime) {
+    return;
+  }
+  CachedArray = array;
+  CachedArrayTime = array ? array->GetMTime() : 0;
+  CachedSettingsTime = GetMTime();
+
+  Histogram.assign(NumberOfBins, 0);
+  Range[0] = Range[1] = 0.0;
+  Total = 0;
+  if (!array) {
+    return;
+  }
+  if (Component >= array->GetNumberOfComponents() || !array->HasStandardMemoryLayout()) {
+    vtkErrorMacro(<< "Update() needs a contiguous array with component " << Component << ".");
+    return;
+  }
+
+  const int stride = array->GetNumberOfComponents();
+  const vtkIdType count = array->GetNumberOfTuples();
+  switch (array->GetDataType()) {
+    vtkTemplateMacro(ComputeStatistics(array,
+      static_cast<const VTK_TT*>(array->GetVoidPointer(0)) + Component,
+      count, stride, Component, NumberOfBins, Range, Histogram));
+    default:
+      vtkErrorMacro(<< "Update() does not support " << array->GetDataTypeAsString() << " arrays.");
+      return;
+  }
+  Total = std::accumulate(Histogram.begin(), Histogram.end(), vtkIdType(0));
+}
+
+void wxVTKVolumeStatistics::GetRange(double range[2]) {
+  range[0] = Range[0];
+  range[1] = Range[1];
+}
+
+double wxVTKVolumeStatistics::GetBinValue(int bin) {
+  return Range[0] + bin * (Range[1] - Range[0]) / NumberOfBins;
+}
+
+double wxVTKVolumeStatistics::GetPercentile(double percent) {
+  if (Total == 0) {
+    return Range[0];
+  }
+  const double target = std::clamp(percent, 0.0, 100.0) / 100.0 * Total;
+  const double width = (Range[1] - Range[0]) / NumberOfBins;
+  double cumulative = 0.0;
+  for (int b = 0; b < static_cast<int>(Histogram.size()); ++b) {
+    if (Histogram[b] > 0 && cumulative + Histogram[b] >= target) {
+      // Assume the values are spread evenly within the bin
+      double fraction = (target - cumulative) / Histogram[b];
+      return GetBinValue(b) + fraction * width;
+    }
+    cumulative += Histogram[b];
+  }
+  return Range[1];
+}
+
+void wxVTKVolumeStatistics::GetWindow(double lowPercent, double highPercent, double window[2]) {
+  window[0] = GetPercentile(lowPercent);
+  window[1] = GetPercentile(highPercent);
+}
+
+void wxVTKVolumeStatistics::PrintSelf(ostream& os, vtkIndent indent) {
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "InputArray: " << InputArray.GetPointer() << "\n";
+  os << indent << "NumberOfBins: " << NumberOfBins << "\n";
+  os << indent << "Component: " << Component << "\n";
+  os << indent << "Range: " << Range[0] << ", " << Range[1] << "\n";
+  os << indent << "NumberOfValues: " << Total << "\n";
+}
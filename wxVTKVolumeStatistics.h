@@ -0,0 +1,82 @@
+/*=========================================================================
+
+  Program:   wxVTK
+  Language:  C++
+
+  Copyright: (c) 2024 Jasmin B. Maglic
+
+=========================================================================*/
+
+// Scalar range, histogram and percentile windows of a volume, for setting up
+// transfer functions and window/level.
+//
+// The passes run in parallel with vtkSMPTools; every thread fills its own
+// partial histogram and the partials are summed at the end. 8- and 16-bit
+// integer scalars are counted over their full domain in a single pass and
+// rebinned. Other types are not single pass: the histogram pass needs the
+// range first, which comes from vtkDataArray::GetRange(). VTK caches that on
+// the array's MTime, so the extra scan only happens when the range has not
+// been asked for since the data changed. In the histogram pass, bin indices
+// are computed in blocks with branch-free code the compiler can vectorise;
+// the counting itself is a scalar scatter. Results are cached on the array
+// and its MTime, so calling Update() again on unchanged data is free.
+
+#pragma once
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+#include <vector>
+
+class vtkDataArray;
+class vtkImageData;
+
+class wxVTKVolumeStatistics : public vtkObject {
+  public:
+  static wxVTKVolumeStatistics* New();
+  vtkTypeMacro(wxVTKVolumeStatistics, vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  // Uses the point scalars of the image
+  void SetInputData(vtkImageData* image);
+  void SetInputArray(vtkDataArray* array);
+  vtkDataArray* GetInputArray();
+
+  vtkSetClampMacro(NumberOfBins, int, 1, 1 << 20);
+  vtkGetMacro(NumberOfBins, int);
+  vtkSetClampMacro(Component, int, 0, VTK_INT_MAX);
+  vtkGetMacro(Component, int);
+
+  // Recomputes only if the array, its MTime or the settings changed
+  void Update();
+
+  void GetRange(double range[2]);
+  vtkIdType GetNumberOfValues() { return Total; }
+  const std::vector<vtkIdType>& GetHistogram() { return Histogram; }
+  // Lower scalar bound of a bin; bins are NumberOfBins equal slices of the range
+  double GetBinValue(int bin);
+
+  // Scalar value below which the given percentage (0-100) of the values lie
+  double GetPercentile(double percent);
+  // Window spanning the given percentiles, e.g. 1 and 99 to ignore outliers
+  void GetWindow(double lowPercent, double highPercent, double window[2]);
+
+  protected:
+  wxVTKVolumeStatistics();
+  ~wxVTKVolumeStatistics() override;
+
+  vtkSmartPointer<vtkDataArray> InputArray;
+  int NumberOfBins;
+  int Component;
+
+  double Range[2];
+  vtkIdType Total;
+  std::vector<vtkIdType> Histogram;
+
+  // Cache key of the current results
+  vtkDataArray* CachedArray;
+  vtkMTimeType CachedArrayTime;
+  vtkMTimeType CachedSettingsTime;
+
+  private:
+  wxVTKVolumeStatistics(const wxVTKVolumeStatistics&) = delete;
+  void operator=(const wxVTKVolumeStatistics&) = delete;
+};